@@ -0,0 +1,456 @@
+// //////////////////////////////////////////////////////////
+// asyncreader.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "asyncreader.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// io_uring needs Linux 5.1 or later, system calls are issued directly (no liburing)
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define ASYNCREADER_IO_URING
+#endif
+#endif
+#endif
+
+
+#ifdef ASYNCREADER_IO_URING
+/// submission and completion queue shared with the kernel
+struct AsyncReader::Ring
+{
+  /// file descriptor of the ring
+  int fd;
+  /// true if all buffers were registered => IORING_OP_READ_FIXED, else IORING_OP_READV
+  bool registered;
+  /// one entry per buffer, IORING_OP_READV needs them while a read is in flight
+  std::vector<struct iovec> iovecs;
+
+  /// memory-mapped queues
+  void*  sqRing;
+  size_t sqRingSize;
+  void*  cqRing;
+  size_t cqRingSize;
+  struct io_uring_sqe* sqes;
+  size_t sqesSize;
+
+  /// pointers into sqRing
+  unsigned* sqTail;
+  unsigned* sqMask;
+  unsigned* sqArray;
+  /// pointers into cqRing
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned* cqMask;
+  struct io_uring_cqe* cqes;
+
+  /// set up a ring and register all buffers, return NULL if io_uring isn't available
+  static Ring* create(const std::vector<Slot>& slots, size_t bufferSize)
+  {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int) syscall(__NR_io_uring_setup, (unsigned) slots.size(), &params);
+    if (fd < 0)
+      return NULL;
+
+    Ring* ring = new Ring;
+    ring->fd         = fd;
+    ring->registered = false;
+    ring->sqRing     = MAP_FAILED;
+    ring->cqRing     = MAP_FAILED;
+    ring->sqes       = (struct io_uring_sqe*) MAP_FAILED;
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes  + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSize   = params.sq_entries * sizeof(struct io_uring_sqe);
+    // Linux 5.4+ shares a single mapping between both queues
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap && ring->cqRingSize > ring->sqRingSize)
+      ring->sqRingSize = ring->cqRingSize;
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing != MAP_FAILED)
+      ring->cqRing = singleMap ? ring->sqRing :
+                     mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (ring->cqRing != MAP_FAILED)
+      ring->sqes = (struct io_uring_sqe*)
+                   mmap(NULL, ring->sqesSize,   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+      delete ring;
+      return NULL;
+    }
+
+    char* sq = (char*) ring->sqRing;
+    char* cq = (char*) ring->cqRing;
+    ring->sqTail  = (unsigned*) (sq + params.sq_off.tail);
+    ring->sqMask  = (unsigned*) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*) (sq + params.sq_off.array);
+    ring->cqHead  = (unsigned*) (cq + params.cq_off.head);
+    ring->cqTail  = (unsigned*) (cq + params.cq_off.tail);
+    ring->cqMask  = (unsigned*) (cq + params.cq_off.ring_mask);
+    ring->cqes    = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+    // registered buffers avoid pinning pages for each read (may fail due to RLIMIT_MEMLOCK on older kernels)
+    ring->iovecs.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      ring->iovecs[i].iov_base = slots[i].data;
+      ring->iovecs[i].iov_len  = bufferSize;
+    }
+    ring->registered = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                               &ring->iovecs[0], (unsigned) ring->iovecs.size()) == 0;
+    return ring;
+  }
+
+  /// unmap queues, close ring
+  ~Ring()
+  {
+    if (sqes != MAP_FAILED)
+      munmap(sqes, sqesSize);
+    if (cqRing != MAP_FAILED && cqRing != sqRing)
+      munmap(cqRing, cqRingSize);
+    if (sqRing != MAP_FAILED)
+      munmap(sqRing, sqRingSize);
+    close(fd);
+  }
+
+  /// queue a read of numBytes into buffer (part of slot's buffer) and hand it to the kernel
+  bool read(int handle, size_t slot, char* buffer, size_t numBytes, uint64_t offset)
+  {
+    unsigned tail  = *sqTail;
+    unsigned index = tail & *sqMask;
+    struct io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd        = handle;
+    sqe->off       = offset;
+    sqe->user_data = slot;
+    if (registered)
+    {
+      sqe->opcode    = IORING_OP_READ_FIXED;
+      sqe->addr      = (uint64_t) (size_t) buffer;
+      sqe->len       = (unsigned) numBytes;
+      sqe->buf_index = (unsigned short) slot;
+    }
+    else
+    {
+      iovecs[slot].iov_base = buffer;
+      iovecs[slot].iov_len  = numBytes;
+      sqe->opcode    = IORING_OP_READV;
+      sqe->addr      = (uint64_t) (size_t) &iovecs[slot];
+      sqe->len       = 1;
+    }
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    while (syscall(__NR_io_uring_enter, fd, 1, 0, 0, NULL, 0) < 0)
+      if (errno != EINTR)
+        return false;
+    return true;
+  }
+
+  /// block until at least one read finished
+  bool wait()
+  {
+    while (syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0)
+      if (errno != EINTR)
+        return false;
+    return true;
+  }
+};
+#else
+/// io_uring not supported
+struct AsyncReader::Ring
+{
+};
+#endif
+
+
+/// start reading at the current position of handle (which stays open, bufferSize must be a multiple of 4096)
+AsyncReader::AsyncReader(int handle, size_t bufferSize, unsigned int numBuffers, bool useIoUring)
+: m_handle(handle),
+  m_seekable(false),
+  m_bufferSize(bufferSize),
+  m_memory(NULL),
+  m_current(0),
+  m_nextSchedule(0),
+  m_nextOffset(0),
+  m_endOfFile(false),
+  m_ring(NULL),
+  m_stop(false)
+{
+  // double buffering at least
+  if (numBuffers < 2)
+    numBuffers = 2;
+
+  // pipes and character devices don't support explicit file offsets
+  struct stat info;
+  if (fstat(handle, &info) == 0 && (S_ISREG(info.st_mode) || S_ISBLK(info.st_mode)))
+  {
+    off_t position = lseek(handle, 0, SEEK_CUR);
+    m_seekable   = position >= 0;
+    m_nextOffset = m_seekable ? uint64_t(position) : 0;
+  }
+
+  // aligned to memory pages
+  void* memory = NULL;
+  if (posix_memalign(&memory, 4096, numBuffers * bufferSize) != 0)
+    throw std::bad_alloc();
+  m_memory = (char*) memory;
+
+  m_slots.resize(numBuffers);
+  for (size_t i = 0; i < m_slots.size(); i++)
+  {
+    m_slots[i].data     = m_memory + i * bufferSize;
+    m_slots[i].offset   = 0;
+    m_slots[i].numBytes = 0;
+    m_slots[i].error    = 0;
+    m_slots[i].state    = Idle;
+  }
+
+  if (useIoUring)
+  {
+#ifdef ASYNCREADER_IO_URING
+    m_ring = Ring::create(m_slots, bufferSize);
+#endif
+  }
+  if (!m_ring)
+    m_thread = std::thread(&AsyncReader::readerLoop, this);
+}
+
+
+/// wait for pending reads, free buffers
+AsyncReader::~AsyncReader()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+    // the kernel must not write into released memory
+    if (m_ring)
+      for (size_t i = 0; i < m_slots.size(); i++)
+        waitFor(i, lock);
+  }
+  m_signal.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+
+  delete m_ring;
+  free(m_memory);
+}
+
+
+/// name of the reader chosen at runtime ("io_uring" or "thread")
+const char* AsyncReader::getImplementation() const
+{
+  return m_ring ? "io_uring" : "thread";
+}
+
+
+/// queue reads for idle buffers (must hold m_mutex)
+void AsyncReader::schedule()
+{
+  while (!m_endOfFile && !m_stop)
+  {
+    size_t id = m_nextSchedule;
+    if (m_slots[id].state != Idle)
+      break;
+
+    // pipes: a single read at a time, else completions could arrive out of order
+    size_t previous = (id + m_slots.size() - 1) % m_slots.size();
+    if (!m_seekable && m_slots[previous].state == Reading)
+      break;
+
+    Slot& slot    = m_slots[id];
+    slot.offset   = m_nextOffset;
+    slot.numBytes = 0;
+    slot.error    = 0;
+    slot.state    = Reading;
+    m_nextOffset += m_bufferSize;
+    m_nextSchedule = (id + 1) % m_slots.size();
+
+    submit(id);
+  }
+}
+
+
+/// start reading into a buffer (or continue after a short read)
+void AsyncReader::submit(size_t id)
+{
+#ifdef ASYNCREADER_IO_URING
+  if (m_ring)
+  {
+    Slot& slot = m_slots[id];
+    // -1 means "current file position"
+    uint64_t offset = m_seekable ? slot.offset + slot.numBytes : uint64_t(-1);
+    if (!m_ring->read(m_handle, id, slot.data + slot.numBytes, m_bufferSize - slot.numBytes, offset))
+    {
+      slot.error = errno;
+      slot.state = Ready;
+    }
+    return;
+  }
+#endif
+
+  // background thread picks it up
+  m_signal.notify_all();
+}
+
+
+/// handle a finished read, true if the buffer is complete
+bool AsyncReader::complete(size_t id, ptrdiff_t result)
+{
+  Slot& slot = m_slots[id];
+  if (result < 0)
+  {
+    // try again
+    if (result == -EINTR || result == -EAGAIN)
+      return false;
+
+    slot.error = int(-result);
+    return true;
+  }
+
+  // end of file
+  if (result == 0)
+    return true;
+
+  // files are always read in full buffers (except for the last one), pipes return whatever is available
+  slot.numBytes += size_t(result);
+  return !m_seekable || slot.numBytes == m_bufferSize;
+}
+
+
+/// block until a buffer is filled (must hold m_mutex, which is released while waiting)
+void AsyncReader::waitFor(size_t id, std::unique_lock<std::mutex>& lock)
+{
+  while (m_slots[id].state == Reading)
+  {
+    if (!m_ring)
+    {
+      m_signal.wait(lock);
+      continue;
+    }
+
+#ifdef ASYNCREADER_IO_URING
+    unsigned head = *m_ring->cqHead;
+    if (head == __atomic_load_n(m_ring->cqTail, __ATOMIC_ACQUIRE))
+    {
+      if (!m_ring->wait())
+      {
+        m_slots[id].error = errno;
+        m_slots[id].state = Ready;
+      }
+      continue;
+    }
+
+    // process all finished reads, not just the one we're waiting for
+    do
+    {
+      struct io_uring_cqe* cqe = &m_ring->cqes[head & *m_ring->cqMask];
+      size_t    finished = size_t(cqe->user_data);
+      ptrdiff_t result   = cqe->res;
+      head++;
+      __atomic_store_n(m_ring->cqHead, head, __ATOMIC_RELEASE);
+
+      if (complete(finished, result))
+        m_slots[finished].state = Ready;
+      else
+        submit(finished);
+    } while (head != __atomic_load_n(m_ring->cqTail, __ATOMIC_ACQUIRE));
+#endif
+  }
+}
+
+
+/// get next chunk, valid until the next call, returns its size or 0 at the end of file or -1 on errors
+ptrdiff_t AsyncReader::next(const void*& data)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // caller is done with the previous buffer
+  if (m_slots[m_current].state == Busy)
+  {
+    m_slots[m_current].state = Idle;
+    m_current = (m_current + 1) % m_slots.size();
+  }
+
+  schedule();
+
+  // nothing scheduled beyond the end of file
+  Slot& slot = m_slots[m_current];
+  if (slot.state == Idle)
+    return 0;
+
+  waitFor(m_current, lock);
+
+  if (slot.error != 0)
+  {
+    m_endOfFile = true;
+    errno = slot.error;
+    return -1;
+  }
+
+  // a partially filled buffer of a regular file is its last one
+  if (slot.numBytes == 0 || (m_seekable && slot.numBytes < m_bufferSize))
+    m_endOfFile = true;
+  if (slot.numBytes == 0)
+    return 0;
+
+  // pipes: read next chunk while this one is processed
+  schedule();
+
+  slot.state = Busy;
+  data = slot.data;
+  return ptrdiff_t(slot.numBytes);
+}
+
+
+/// main loop of the background thread (if io_uring isn't available)
+void AsyncReader::readerLoop()
+{
+  // buffers are filled in the same order as they are scheduled
+  size_t id = 0;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    while (!m_stop && m_slots[id].state != Reading)
+      m_signal.wait(lock);
+    if (m_stop)
+      return;
+
+    // this thread owns the buffer until it's ready
+    Slot& slot = m_slots[id];
+    lock.unlock();
+
+    bool done = false;
+    while (!done)
+    {
+      char*  target    = slot.data + slot.numBytes;
+      size_t numBytes  = m_bufferSize - slot.numBytes;
+      ptrdiff_t result = m_seekable ? pread(m_handle, target, numBytes, off_t(slot.offset + slot.numBytes))
+                                    : read (m_handle, target, numBytes);
+      done = complete(id, result < 0 ? -errno : result);
+    }
+
+    lock.lock();
+    slot.state = Ready;
+    m_signal.notify_all();
+
+    id = (id + 1) % m_slots.size();
+  }
+}
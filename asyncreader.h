@@ -0,0 +1,126 @@
+// //////////////////////////////////////////////////////////
+// asyncreader.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// read a file sequentially while the caller processes the previous chunk (POSIX only)
+/** Usage:
+    AsyncReader reader(handle);
+    const void* data;
+    ptrdiff_t   numBytes;
+    while ((numBytes = reader.next(data)) > 0)
+      sha256.add(data, numBytes);
+    if (numBytes < 0)
+      ... read error ...
+
+    Note:
+    Linux uses io_uring (raw system calls, no liburing needed) with registered buffers:
+    several reads are in flight while the caller hashes the oldest one.
+    If io_uring isn't available (old kernels, disabled by seccomp/sysctl) a background thread reads ahead.
+    Regular files and block devices keep all buffers busy, pipes have only one read in flight.
+    All buffers are aligned to 4096 bytes so that the handle may be opened with O_DIRECT.
+  */
+class AsyncReader
+{
+public:
+  /// about 1 MByte (divisible by 144 => improves Keccak/SHA3 performance, divisible by 4096 => O_DIRECT)
+  enum { DefaultBufferSize = 144*7*1024, DefaultNumBuffers = 4 };
+
+  /// start reading at the current position of handle (which stays open, bufferSize must be a multiple of 4096),
+  /// useIoUring = false always reads on a background thread
+  explicit AsyncReader(int handle, size_t bufferSize = DefaultBufferSize, unsigned int numBuffers = DefaultNumBuffers,
+                       bool useIoUring = true);
+  /// wait for pending reads, free buffers
+  ~AsyncReader();
+
+  /// get next chunk, valid until the next call, returns its size or 0 at the end of file or -1 on errors
+  ptrdiff_t next(const void*& data);
+
+  /// name of the reader chosen at runtime ("io_uring" or "thread")
+  const char* getImplementation() const;
+
+private:
+  /// no copies
+  AsyncReader(const AsyncReader&);
+  AsyncReader& operator=(const AsyncReader&);
+
+  /// life-cycle of a buffer
+  enum State { Idle, Reading, Ready, Busy };
+
+  /// a single buffer
+  struct Slot
+  {
+    /// points into m_memory
+    char*    data;
+    /// file position of the first byte
+    uint64_t offset;
+    /// bytes read so far
+    size_t   numBytes;
+    /// errno of a failed read, else zero
+    int      error;
+    /// see enum State
+    State    state;
+  };
+
+  /// queue reads for idle buffers (must hold m_mutex)
+  void schedule();
+  /// start reading into a buffer (or continue after a short read)
+  void submit(size_t slot);
+  /// block until a buffer is filled (must hold m_mutex, which is released while waiting)
+  void waitFor(size_t slot, std::unique_lock<std::mutex>& lock);
+  /// handle a finished read, true if the buffer is complete
+  bool complete(size_t slot, ptrdiff_t result);
+  /// main loop of the background thread (if io_uring isn't available)
+  void readerLoop();
+
+  /// file handle
+  int    m_handle;
+  /// true for regular files and block devices: read with explicit file offsets
+  bool   m_seekable;
+  /// size of each buffer
+  size_t m_bufferSize;
+  /// all buffers in a single aligned block
+  char*  m_memory;
+  /// all buffers
+  std::vector<Slot> m_slots;
+  /// buffer returned by the next call of next()
+  size_t m_current;
+  /// next buffer to be scheduled
+  size_t m_nextSchedule;
+  /// file position of the next scheduled read
+  uint64_t m_nextOffset;
+  /// a read returned zero bytes
+  bool   m_endOfFile;
+
+  /// io_uring state (defined in asyncreader.cpp), NULL if not available
+  struct Ring;
+  Ring*  m_ring;
+
+  /// background thread, only used if m_ring is NULL
+  std::thread             m_thread;
+  /// protects m_slots, m_endOfFile and m_stop
+  std::mutex              m_mutex;
+  /// wakes up reader and consumer
+  std::condition_variable m_signal;
+  /// true if destructor was called
+  bool                    m_stop;
+};
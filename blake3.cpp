@@ -0,0 +1,524 @@
+// //////////////////////////////////////////////////////////
+// blake3.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "blake3.h"
+#include "threadpool.h"
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#include <cstring> // memcpy
+
+
+// SIMD kernels need GCC's / Clang's vector extensions and x86 target attributes
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BLAKE3_SIMD
+#define BLAKE3_INLINE inline __attribute__((always_inline))
+#else
+#define BLAKE3_INLINE inline
+#endif
+
+
+/// constants and local helper functions
+namespace
+{
+  /// same as SHA256's initial hash
+  const uint32_t IV[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                           0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+  /// message word order of each round
+  const unsigned char MsgSchedule[7][16] =
+  {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+    {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+    { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+    { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+    {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+    { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 }
+  };
+
+  /// domain separation flags
+  enum Flags { ChunkStart = 1, ChunkEnd = 2, Parent = 4, Root = 8 };
+
+  /// chunks per task in multi-threaded mode (must be a power of two)
+  const size_t ChunksPerTask = 64;
+  /// log2(ChunksPerTask)
+  const unsigned int TaskHeight = 6;
+
+  /// convert litte vs big endian
+  inline uint32_t swap(uint32_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(x);
+#endif
+#ifdef MSC_VER
+    return _byteswap_ulong(x);
+#endif
+
+    return (x >> 24) |
+          ((x >>  8) & 0x0000FF00) |
+          ((x <<  8) & 0x00FF0000) |
+           (x << 24);
+  }
+
+  /// read 4 bytes, may be unaligned
+  inline uint32_t load32(const uint8_t* data)
+  {
+    uint32_t result;
+    memcpy(&result, data, 4);
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+    result = swap(result);
+#endif
+    return result;
+  }
+
+  /// rotate right and wrap around to the left (works for scalars and vectors)
+#define ROTATERIGHT(x, numBits) (((x) >> (numBits)) | ((x) << (32 - (numBits))))
+
+  /// mix two message words into four state words
+#define G(a, b, c, d, x, y)                                   \
+  v[a] = v[a] + v[b] + (x); v[d] = ROTATERIGHT(v[d] ^ v[a], 16); \
+  v[c] = v[c] + v[d];       v[b] = ROTATERIGHT(v[b] ^ v[c], 12); \
+  v[a] = v[a] + v[b] + (y); v[d] = ROTATERIGHT(v[d] ^ v[a],  8); \
+  v[c] = v[c] + v[d];       v[b] = ROTATERIGHT(v[b] ^ v[c],  7);
+
+  /// one round: mix columns, then diagonals
+#define ROUND(r)                                                                  \
+  G(0, 4,  8, 12, m[MsgSchedule[r][ 0]], m[MsgSchedule[r][ 1]])                   \
+  G(1, 5,  9, 13, m[MsgSchedule[r][ 2]], m[MsgSchedule[r][ 3]])                   \
+  G(2, 6, 10, 14, m[MsgSchedule[r][ 4]], m[MsgSchedule[r][ 5]])                   \
+  G(3, 7, 11, 15, m[MsgSchedule[r][ 6]], m[MsgSchedule[r][ 7]])                   \
+  G(0, 5, 10, 15, m[MsgSchedule[r][ 8]], m[MsgSchedule[r][ 9]])                   \
+  G(1, 6, 11, 12, m[MsgSchedule[r][10]], m[MsgSchedule[r][11]])                   \
+  G(2, 7,  8, 13, m[MsgSchedule[r][12]], m[MsgSchedule[r][13]])                   \
+  G(3, 4,  9, 14, m[MsgSchedule[r][14]], m[MsgSchedule[r][15]])
+
+  /// compression function, returns full 16 word state
+  void compress(const uint32_t cv[8], const uint32_t m[16], uint64_t counter, uint32_t blockLength, uint32_t flags,
+                uint32_t result[16])
+  {
+    uint32_t v[16] = { cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                       IV[0], IV[1], IV[2], IV[3],
+                       uint32_t(counter), uint32_t(counter >> 32), blockLength, flags };
+
+    ROUND(0) ROUND(1) ROUND(2) ROUND(3) ROUND(4) ROUND(5) ROUND(6)
+
+    for (unsigned int i = 0; i < 8; i++)
+    {
+      result[i]     = v[i] ^ v[i + 8];
+      result[i + 8] = v[i + 8] ^ cv[i];
+    }
+  }
+
+  /// everything needed to compute a node's chaining value or (if it's the root) the final hash
+  struct Output
+  {
+    uint32_t cv[8];
+    uint32_t block[16];
+    uint64_t counter;
+    uint32_t blockLength;
+    uint32_t flags;
+
+    /// non-root chaining value
+    void chainingValue(uint32_t result[8]) const
+    {
+      uint32_t state[16];
+      compress(cv, block, counter, blockLength, flags, state);
+      memcpy(result, state, 8 * sizeof(uint32_t));
+    }
+  };
+
+  /// process a chunk (up to 1024 bytes) except for its last block
+  Output chunkOutput(const uint8_t* data, size_t numBytes, uint64_t counter)
+  {
+    Output result;
+    memcpy(result.cv, IV, sizeof(IV));
+    result.counter = counter;
+
+    // at least one (possibly empty) block
+    size_t numBlocks = numBytes == 0 ? 1 : (numBytes + BLAKE3::BlockSize - 1) / BLAKE3::BlockSize;
+    uint32_t flags = ChunkStart;
+    for (size_t i = 0; i + 1 < numBlocks; i++)
+    {
+      uint32_t m[16];
+      for (unsigned int j = 0; j < 16; j++)
+        m[j] = load32(data + 4*j);
+
+      uint32_t state[16];
+      compress(result.cv, m, counter, BLAKE3::BlockSize, flags, state);
+      memcpy(result.cv, state, sizeof(result.cv));
+
+      data     += BLAKE3::BlockSize;
+      numBytes -= BLAKE3::BlockSize;
+      flags     = 0;
+    }
+
+    // last block, filled with zeros
+    uint8_t last[BLAKE3::BlockSize] = { 0 };
+    memcpy(last, data, numBytes);
+    for (unsigned int j = 0; j < 16; j++)
+      result.block[j] = load32(last + 4*j);
+    result.blockLength = uint32_t(numBytes);
+    result.flags       = flags | ChunkEnd;
+    return result;
+  }
+
+  /// parent node
+  Output parentOutput(const uint32_t left[8], const uint32_t right[8])
+  {
+    Output result;
+    memcpy(result.cv,        IV,    sizeof(IV));
+    memcpy(result.block,     left,  8 * sizeof(uint32_t));
+    memcpy(result.block + 8, right, 8 * sizeof(uint32_t));
+    result.counter     = 0;
+    result.blockLength = BLAKE3::BlockSize;
+    result.flags       = Parent;
+    return result;
+  }
+
+  /// chaining value of a parent node
+  void parentChainingValue(const uint32_t left[8], const uint32_t right[8], uint32_t result[8])
+  {
+    parentOutput(left, right).chainingValue(result);
+  }
+
+  /// compute chaining values of numChunks full chunks, one after another
+  void hashChunksPortable(const uint8_t* data, size_t numChunks, uint64_t counter, uint32_t* cvs)
+  {
+    for (size_t i = 0; i < numChunks; i++)
+      chunkOutput(data + i * BLAKE3::ChunkSize, BLAKE3::ChunkSize, counter + i).chainingValue(cvs + 8*i);
+  }
+
+#ifdef BLAKE3_SIMD
+  typedef uint32_t Lanes4  __attribute__((vector_size(16)));
+  typedef uint32_t Lanes8  __attribute__((vector_size(32)));
+  typedef uint32_t Lanes16 __attribute__((vector_size(64)));
+
+  /// compute chaining values of numLanes full chunks at once, each vector element belongs to a different chunk
+  template <typename Lanes, unsigned int NumLanes>
+  BLAKE3_INLINE void hashChunksSimd(const uint8_t* data, uint64_t counter, uint32_t* cvs)
+  {
+    const Lanes zero = {};
+
+    Lanes cv[8] = { zero + IV[0], zero + IV[1], zero + IV[2], zero + IV[3],
+                    zero + IV[4], zero + IV[5], zero + IV[6], zero + IV[7] };
+
+    Lanes counterLow, counterHigh;
+    for (unsigned int lane = 0; lane < NumLanes; lane++)
+    {
+      counterLow [lane] = uint32_t( counter + lane);
+      counterHigh[lane] = uint32_t((counter + lane) >> 32);
+    }
+
+    for (unsigned int block = 0; block < BLAKE3::ChunkSize / BLAKE3::BlockSize; block++)
+    {
+      // transpose: message word i of all chunks
+      Lanes m[16];
+      for (unsigned int i = 0; i < 16; i++)
+        for (unsigned int lane = 0; lane < NumLanes; lane++)
+          m[i][lane] = load32(data + lane * BLAKE3::ChunkSize + block * BLAKE3::BlockSize + 4*i);
+
+      uint32_t flags = 0;
+      if (block == 0)
+        flags |= ChunkStart;
+      if (block == BLAKE3::ChunkSize / BLAKE3::BlockSize - 1)
+        flags |= ChunkEnd;
+
+      Lanes v[16] = { cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                      zero + IV[0], zero + IV[1], zero + IV[2], zero + IV[3],
+                      counterLow, counterHigh, zero + uint32_t(BLAKE3::BlockSize), zero + flags };
+
+      ROUND(0) ROUND(1) ROUND(2) ROUND(3) ROUND(4) ROUND(5) ROUND(6)
+
+      for (unsigned int i = 0; i < 8; i++)
+        cv[i] = v[i] ^ v[i + 8];
+    }
+
+    for (unsigned int lane = 0; lane < NumLanes; lane++)
+      for (unsigned int i = 0; i < 8; i++)
+        cvs[8 * lane + i] = cv[i][lane];
+  }
+
+  /// 4 chunks at once
+  __attribute__((target("sse4.1")))
+  void hashChunksSse41(const uint8_t* data, size_t numChunks, uint64_t counter, uint32_t* cvs)
+  {
+    for (; numChunks >= 4; numChunks -= 4, data += 4 * BLAKE3::ChunkSize, counter += 4, cvs += 4 * 8)
+      hashChunksSimd<Lanes4, 4>(data, counter, cvs);
+    hashChunksPortable(data, numChunks, counter, cvs);
+  }
+
+  /// 8 chunks at once
+  __attribute__((target("avx2")))
+  void hashChunksAvx2(const uint8_t* data, size_t numChunks, uint64_t counter, uint32_t* cvs)
+  {
+    for (; numChunks >= 8; numChunks -= 8, data += 8 * BLAKE3::ChunkSize, counter += 8, cvs += 8 * 8)
+      hashChunksSimd<Lanes8, 8>(data, counter, cvs);
+    hashChunksSse41(data, numChunks, counter, cvs);
+  }
+
+  /// 16 chunks at once
+  __attribute__((target("avx512f")))
+  void hashChunksAvx512(const uint8_t* data, size_t numChunks, uint64_t counter, uint32_t* cvs)
+  {
+    for (; numChunks >= 16; numChunks -= 16, data += 16 * BLAKE3::ChunkSize, counter += 16, cvs += 16 * 8)
+      hashChunksSimd<Lanes16, 16>(data, counter, cvs);
+    hashChunksAvx2(data, numChunks, counter, cvs);
+  }
+#endif
+
+  /// signature of all chunk kernels
+  typedef void (*HashChunks)(const uint8_t* data, size_t numChunks, uint64_t counter, uint32_t* cvs);
+
+  /// a kernel and its name
+  struct Kernel
+  {
+    HashChunks  function;
+    const char* name;
+  };
+
+  /// pick fastest kernel supported by the CPU
+  Kernel selectKernel()
+  {
+    Kernel result = { hashChunksPortable, "portable" };
+#ifdef BLAKE3_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      result.function = hashChunksAvx512;
+      result.name     = "avx512";
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+      result.function = hashChunksAvx2;
+      result.name     = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse4.1"))
+    {
+      result.function = hashChunksSse41;
+      result.name     = "sse4.1";
+    }
+#endif
+    return result;
+  }
+
+  /// chosen on first use
+  const Kernel& getKernel()
+  {
+    static const Kernel kernel = selectKernel();
+    return kernel;
+  }
+}
+
+
+/// same as reset(), pool = NULL means single-threaded
+BLAKE3::BLAKE3(ThreadPool* pool)
+: m_pool(pool)
+{
+  reset();
+}
+
+
+/// restart
+void BLAKE3::reset()
+{
+  m_numChunks  = 0;
+  m_bufferSize = 0;
+  m_stack.clear();
+}
+
+
+/// name of the compression kernel chosen at runtime ("portable", "sse4.1", "avx2" or "avx512")
+const char* BLAKE3::getImplementation()
+{
+  return getKernel().name;
+}
+
+
+/// push a subtree and merge all subtrees of equal height
+void BLAKE3::push(const Node& node)
+{
+  Node current = node;
+  // works like incrementing a binary counter (these nodes are never the root because more data follows)
+  while (!m_stack.empty() && m_stack.back().height == current.height)
+  {
+    parentChainingValue(m_stack.back().cv, current.cv, current.cv);
+    current.height++;
+    m_stack.pop_back();
+  }
+  m_stack.push_back(current);
+}
+
+
+/// compress numChunks full chunks and merge them into the tree, more data must follow
+void BLAKE3::processChunks(const uint8_t* data, size_t numChunks)
+{
+  HashChunks hashChunks = getKernel().function;
+
+  // split into perfect subtrees which can be hashed independently
+  if (m_pool != NULL && numChunks >= 2 * ChunksPerTask)
+  {
+    // single-threaded until aligned to a subtree boundary
+    size_t unaligned = size_t((ChunksPerTask - m_numChunks % ChunksPerTask) % ChunksPerTask);
+    processChunks(data, unaligned);
+    data      += unaligned * ChunkSize;
+    numChunks -= unaligned;
+
+    size_t   numTasks = numChunks / ChunksPerTask;
+    uint64_t counter  = m_numChunks;
+    std::vector<Node> subtrees(numTasks);
+    m_pool->run(numTasks, [&](size_t task)
+    {
+      uint32_t cvs[ChunksPerTask * 8];
+      hashChunks(data + task * ChunksPerTask * ChunkSize, ChunksPerTask, counter + task * ChunksPerTask, cvs);
+
+      // merge pairs until only the subtree's root is left
+      for (size_t width = ChunksPerTask; width > 1; width /= 2)
+        for (size_t i = 0; i < width / 2; i++)
+          parentChainingValue(cvs + 16*i, cvs + 16*i + 8, cvs + 8*i);
+
+      subtrees[task].height = TaskHeight;
+      memcpy(subtrees[task].cv, cvs, sizeof(subtrees[task].cv));
+    });
+
+    for (size_t i = 0; i < numTasks; i++)
+      push(subtrees[i]);
+    m_numChunks += numTasks * ChunksPerTask;
+    data        += numTasks * ChunksPerTask * ChunkSize;
+    numChunks   -= numTasks * ChunksPerTask;
+  }
+
+  // single-threaded, but still several chunks at once
+  while (numChunks > 0)
+  {
+    const size_t MaxChunks = 64;
+    size_t batch = numChunks < MaxChunks ? numChunks : MaxChunks;
+
+    uint32_t cvs[MaxChunks * 8];
+    hashChunks(data, batch, m_numChunks, cvs);
+
+    Node node;
+    node.height = 0;
+    for (size_t i = 0; i < batch; i++)
+    {
+      memcpy(node.cv, cvs + 8*i, sizeof(node.cv));
+      push(node);
+    }
+
+    m_numChunks += batch;
+    data        += batch * ChunkSize;
+    numChunks   -= batch;
+  }
+}
+
+
+/// add arbitrary number of bytes
+void BLAKE3::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  // fill buffer
+  if (m_bufferSize > 0)
+  {
+    size_t copy = ChunkSize - m_bufferSize;
+    if (copy > numBytes)
+      copy = numBytes;
+    memcpy(m_buffer + m_bufferSize, current, copy);
+    m_bufferSize += copy;
+    current      += copy;
+    numBytes     -= copy;
+
+    // no more data ? then the buffered chunk might be the last one
+    if (numBytes == 0)
+      return;
+
+    processChunks(m_buffer, 1);
+    m_bufferSize = 0;
+  }
+
+  // process full chunks without copying them, but always keep the last chunk
+  if (numBytes > ChunkSize)
+  {
+    size_t numChunks = (numBytes - 1) / ChunkSize;
+    processChunks(current, numChunks);
+    current  += numChunks * ChunkSize;
+    numBytes -= numChunks * ChunkSize;
+  }
+
+  // keep remaining bytes in buffer
+  memcpy(m_buffer + m_bufferSize, current, numBytes);
+  m_bufferSize += numBytes;
+}
+
+
+/// return latest hash as 64 hex characters
+std::string BLAKE3::getHash()
+{
+  // compute hash (as raw bytes)
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * HashBytes);
+  for (int i = 0; i < HashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes
+void BLAKE3::getHash(unsigned char buffer[BLAKE3::HashBytes])
+{
+  // last chunk
+  Output output = chunkOutput(m_buffer, m_bufferSize, m_numChunks);
+
+  // merge subtrees from right to left
+  for (size_t i = m_stack.size(); i > 0; i--)
+  {
+    uint32_t cv[8];
+    output.chainingValue(cv);
+    output = parentOutput(m_stack[i - 1].cv, cv);
+  }
+
+  // finalize root
+  uint32_t state[16];
+  compress(output.cv, output.block, output.counter, output.blockLength, output.flags | Root, state);
+
+  for (int i = 0; i < HashBytes / 4; i++)
+  {
+    *buffer++ = (unsigned char)( state[i]        & 0xFF);
+    *buffer++ = (unsigned char)((state[i] >>  8) & 0xFF);
+    *buffer++ = (unsigned char)((state[i] >> 16) & 0xFF);
+    *buffer++ = (unsigned char)( state[i] >> 24);
+  }
+}
+
+
+/// compute BLAKE3 of a memory block
+std::string BLAKE3::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute BLAKE3 of a string, excluding final zero
+std::string BLAKE3::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
@@ -0,0 +1,96 @@
+// //////////////////////////////////////////////////////////
+// blake3.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+#include <vector>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+class ThreadPool;
+
+
+/// compute BLAKE3 hash
+/** Usage:
+    BLAKE3 blake3;
+    std::string myHash  = blake3("Hello World");     // std::string
+    std::string myHash2 = blake3("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    BLAKE3 blake3(&ThreadPool::shared());           // use all CPU cores for large inputs
+    while (more data available)
+      blake3.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = blake3.getHash();
+
+    Note:
+    Several chunks (1 KB each) are compressed at once by SSE4.1, AVX2 or AVX-512 code if the CPU supports it,
+    the fastest implementation is chosen at runtime (GCC and Clang on x86 only, else a portable implementation is used).
+    If a thread pool is provided then large inputs are split into subtrees which are hashed in parallel.
+  */
+class BLAKE3 //: public Hash
+{
+public:
+  /// split into 64 byte blocks (=> 512 bits), hash is 32 bytes long
+  enum { BlockSize = 512 / 8, HashBytes = 32, ChunkSize = 1024 };
+
+  /// same as reset(), pool = NULL means single-threaded
+  explicit BLAKE3(ThreadPool* pool = NULL);
+
+  /// compute BLAKE3 of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute BLAKE3 of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 64 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+  /// name of the compression kernel chosen at runtime ("portable", "sse4.1", "avx2" or "avx512")
+  static const char* getImplementation();
+
+private:
+  /// chaining value of a perfect subtree
+  struct Node
+  {
+    unsigned int height;
+    uint32_t     cv[8];
+  };
+
+  /// compress numChunks full chunks and merge them into the tree, more data must follow
+  void processChunks(const uint8_t* data, size_t numChunks);
+  /// push a subtree and merge all subtrees of equal height
+  void push(const Node& node);
+
+  /// workers (NULL if single-threaded)
+  ThreadPool*       m_pool;
+  /// number of chunks merged into m_stack
+  uint64_t          m_numChunks;
+  /// roots of all complete subtrees, heights are strictly decreasing
+  std::vector<Node> m_stack;
+  /// valid bytes in m_buffer
+  size_t            m_bufferSize;
+  /// current chunk, not processed yet
+  uint8_t           m_buffer[ChunkSize];
+};
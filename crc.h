@@ -0,0 +1,394 @@
+// //////////////////////////////////////////////////////////
+// crc.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int16 uint16_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+// carry-less multiplication needs GCC's / Clang's x86 intrinsics and target attributes
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CRC_PCLMUL
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+
+/// compute CRC of any width (8 to 64 bits, multiple of 8) and polynomial
+/** Usage:
+    CRC16 crc16;
+    std::string myHash  = crc16("Hello World");     // std::string
+    std::string myHash2 = crc16("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    CRC32_BZIP2 bzip2;
+    while (more data available)
+      bzip2.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = bzip2.getHash();
+
+    // other CRCs: parameters are listed in the "Catalogue of parametrised CRC algorithms"
+    typedef CRC<24, 0x864CFB, false, 0xB704CE, 0> CRC24_OpenPGP;
+
+    Note:
+    Polynomial is written in normal (non-reflected) notation, without its highest bit.
+    All look-up tables and folding constants are computed by the compiler.
+    x86 CPUs with carry-less multiplication (PCLMULQDQ) fold 64 bytes per iteration (GCC and Clang only),
+    else a Slicing-by-8 algorithm is used.
+  */
+template <unsigned int Width, uint64_t Polynomial, bool Reflected, uint64_t Init, uint64_t XorOut>
+class CRC //: public Hash
+{
+public:
+  /// hash is Width bits long
+  enum { HashBytes = Width / 8 };
+
+  /// same as reset()
+  CRC()
+  {
+    reset();
+  }
+
+  /// compute CRC of a memory block
+  std::string operator()(const void* data, size_t numBytes)
+  {
+    reset();
+    add(data, numBytes);
+    return getHash();
+  }
+
+  /// compute CRC of a string, excluding final zero
+  std::string operator()(const std::string& text)
+  {
+    reset();
+    add(text.c_str(), text.size());
+    return getHash();
+  }
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes)
+  {
+#ifdef CRC_PCLMUL
+    if (hasPclmul())
+    {
+      m_hash = pclmul((const uint8_t*) data, numBytes, m_hash);
+      return;
+    }
+#endif
+    m_hash = slicing8((const uint8_t*) data, numBytes, m_hash);
+  }
+
+  /// return latest hash as hex characters
+  std::string getHash()
+  {
+    // convert hash to string
+    static const char dec2hex[16+1] = "0123456789abcdef";
+
+    uint64_t hash = m_hash ^ XorOut;
+    char hashBuffer[Width / 4 + 1];
+    for (unsigned int i = 0; i < Width / 4; i++)
+      hashBuffer[i] = dec2hex[(hash >> (Width - 4 - 4 * i)) & 15];
+    // zero-terminated string
+    hashBuffer[Width / 4] = 0;
+
+    // convert to std::string
+    return hashBuffer;
+  }
+
+  /// return latest hash as bytes
+  void getHash(unsigned char buffer[HashBytes])
+  {
+    uint64_t hash = m_hash ^ XorOut;
+    for (unsigned int i = 0; i < HashBytes; i++)
+      buffer[i] = (hash >> (Width - 8 - 8 * i)) & 0xFF;
+  }
+
+  /// restart
+  void reset()
+  {
+    m_hash = InitialValue;
+  }
+
+  /// name of the algorithm chosen at runtime ("pclmul" or "slicing-by-8")
+  static const char* getImplementation()
+  {
+    return hasPclmul() ? "pclmul" : "slicing-by-8";
+  }
+
+private:
+  static_assert(Width >= 8 && Width <= 64 && Width % 8 == 0, "CRC width must be 8, 16, 24, ... or 64 bits");
+
+  /// all bits set
+  static constexpr uint64_t Mask = ~0ULL >> (64 - Width);
+
+  // //////////////////////////////////////////////////////////
+  // compile-time arithmetic (C++11 constexpr, therefore recursive)
+
+  /// mirror the lowest numBits bits
+  static constexpr uint64_t reflect(uint64_t value, unsigned int numBits)
+  {
+    return numBits == 0 ? 0 : ((value & 1) << (numBits - 1)) | reflect(value >> 1, numBits - 1);
+  }
+
+  /// multiply by x modulo polynomial (normal notation)
+  static constexpr uint64_t timesX(uint64_t value)
+  {
+    return ((value << 1) & Mask) ^ (((value >> (Width - 1)) & 1) ? Polynomial : 0);
+  }
+
+  /// a * b modulo polynomial, Horner's scheme from bit Width - 1 down to bit "bit"
+  static constexpr uint64_t multiplyModulo(uint64_t a, uint64_t b, unsigned int bit = 0)
+  {
+    return bit == Width ? 0 : timesX(multiplyModulo(a, b, bit + 1)) ^ (((a >> bit) & 1) ? b : 0);
+  }
+
+  /// x^exponent modulo polynomial (normal notation)
+  static constexpr uint64_t powerOfX(unsigned int exponent)
+  {
+    return exponent == 0 ? 1 :
+           exponent  & 1 ? timesX(powerOfX(exponent - 1)) :
+                           square(powerOfX(exponent / 2));
+  }
+  static constexpr uint64_t square(uint64_t value)
+  {
+    return multiplyModulo(value, value);
+  }
+
+  /// polynomial with reversed bit order
+  static constexpr uint64_t ReflectedPolynomial = reflect(Polynomial, Width);
+  /// register starts with Init, reflected CRCs keep their register in reversed bit order
+  static constexpr uint64_t InitialValue = Reflected ? reflect(Init, Width) : Init;
+
+  /// CRC of a single byte (register starts with zero)
+  static constexpr uint64_t singleByte(uint64_t crc, unsigned int bit = 0)
+  {
+    return bit == 8 ? crc :
+           Reflected ? singleByte( (crc >> 1)          ^ ((crc & 1)                  ? ReflectedPolynomial : 0), bit + 1) :
+                       singleByte(((crc << 1) & Mask) ^ (((crc >> (Width - 1)) & 1) ? Polynomial          : 0), bit + 1);
+  }
+
+  /// process a zero byte
+  static constexpr uint64_t zeroByte(uint64_t crc)
+  {
+    return Reflected ?  (crc >> 8)          ^ singleByte(crc & 0xFF) :
+                       ((crc << 8) & Mask) ^ singleByte(crc & (Mask ^ (Mask >> 8)));
+  }
+
+  /// CRC of byte "value" followed by "slice" zeros
+  static constexpr uint64_t entry(unsigned int slice, unsigned int value)
+  {
+    return slice == 0 ? singleByte(Reflected ? value : uint64_t(value) << (Width - 8)) : zeroByte(entry(slice - 1, value));
+  }
+
+  /// a pack of integers 0, 1, 2, ...
+  template <unsigned int... I> struct Indices {};
+  template <typename A, typename B> struct Concat;
+  template <unsigned int... I, unsigned int... J> struct Concat<Indices<I...>, Indices<J...> >
+  { typedef Indices<I..., (sizeof...(I) + J)...> Type; };
+  /// logarithmic recursion depth
+  template <unsigned int N, int Dummy = 0> struct MakeIndices
+  { typedef typename Concat<typename MakeIndices<N / 2>::Type, typename MakeIndices<N - N / 2>::Type>::Type Type; };
+  template <int Dummy> struct MakeIndices<1, Dummy> { typedef Indices<0> Type; };
+
+  /// 8 slices of 256 entries each
+  struct Lookup
+  {
+    uint64_t values[8 * 256];
+  };
+
+  template <unsigned int... I>
+  static constexpr Lookup makeLookup(Indices<I...>)
+  {
+    return Lookup{ { entry(I / 256, I % 256)... } };
+  }
+
+  /// slicing-by-8 tables
+  static constexpr Lookup lookup = makeLookup(typename MakeIndices<8 * 256>::Type());
+
+  // carry-less multiplication treats a reflected 128 bit block as two 64 bit polynomials:
+  // the first eight bytes are the higher part, the product of two reflected values is off by one bit
+  // => constants for folding D bits are x^(D+63) and x^(D-1) (reflected) or x^(D+64) and x^D (not reflected)
+  /// low and high 64 bits of the folding constants
+  static constexpr uint64_t foldLow (unsigned int distance)
+  {
+    return Reflected ? reflect(powerOfX(distance + 63), 64) : powerOfX(distance);
+  }
+  static constexpr uint64_t foldHigh(unsigned int distance)
+  {
+    return Reflected ? reflect(powerOfX(distance -  1), 64) : powerOfX(distance + 64);
+  }
+
+  // //////////////////////////////////////////////////////////
+  // kernels, crc is the register before the final XOR
+
+  /// read eight bytes, reflected CRCs need little endian, else big endian
+  static uint64_t load(const uint8_t* data)
+  {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+      value |= uint64_t(data[i]) << (Reflected ? 8 * i : 56 - 8 * i);
+    return value;
+  }
+
+  /// Slicing-by-8
+  static uint64_t slicing8(const uint8_t* data, size_t numBytes, uint64_t crc)
+  {
+    const uint64_t* table = lookup.values;
+
+    // process eight bytes at once
+    while (numBytes >= 8)
+    {
+      // the register affects the first Width / 8 bytes
+      uint64_t value = load(data) ^ (Reflected ? crc : crc << (64 - Width));
+      crc = 0;
+      for (int i = 0; i < 8; i++)
+      {
+        unsigned int byte = (value >> (Reflected ? 8 * i : 56 - 8 * i)) & 0xFF;
+        crc ^= table[(7 - i) * 256 + byte];
+      }
+      data     += 8;
+      numBytes -= 8;
+    }
+
+    // remaining 1 to 7 bytes (standard CRC table-based algorithm)
+    while (numBytes--)
+    {
+      if (Reflected)
+        crc =  (crc >> 8)          ^ table[(crc & 0xFF) ^ *data++];
+      else
+        crc = ((crc << 8) & Mask) ^ table[((crc >> (Width - 8)) & 0xFF) ^ *data++];
+    }
+
+    return crc;
+  }
+
+  /// true if the CPU supports carry-less multiplication (and SSSE3 for byte swapping)
+  static bool hasPclmul()
+  {
+#ifdef CRC_PCLMUL
+    struct Detect
+    {
+      static bool run()
+      {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+      }
+    };
+    // checked on first use
+    static const bool supported = Detect::run();
+    return supported;
+#else
+    return false;
+#endif
+  }
+
+#ifdef CRC_PCLMUL
+  /// load 16 bytes, non-reflected CRCs need them in reverse order
+  __attribute__((target("pclmul,ssse3")))
+  static inline __m128i loadBlock(const uint8_t* data)
+  {
+    __m128i block = _mm_loadu_si128((const __m128i*)data);
+    if (!Reflected)
+      block = _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    return block;
+  }
+
+  /// multiply both halves of a by the matching folding constant and add b
+  __attribute__((target("pclmul,ssse3")))
+  static inline __m128i fold(__m128i a, __m128i constants, __m128i b)
+  {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(a, constants, 0x00),
+                                       _mm_clmulepi64_si128(a, constants, 0x11)), b);
+  }
+
+  /// carry-less multiplication
+  __attribute__((target("pclmul,ssse3")))
+  static uint64_t pclmul(const uint8_t* data, size_t numBytes, uint64_t crc)
+  {
+    // short input: not worth the setup
+    if (numBytes < 128)
+      return slicing8(data, numBytes, crc);
+
+    // the register affects the first Width / 8 bytes the same way as XORing it into them
+    __m128i x0 = _mm_xor_si128(loadBlock(data), Reflected ? _mm_cvtsi64_si128((long long) crc) :
+                                                            _mm_set_epi64x((long long)(crc << (64 - Width)), 0));
+    __m128i x1 = loadBlock(data + 16);
+    __m128i x2 = loadBlock(data + 32);
+    __m128i x3 = loadBlock(data + 48);
+    data     += 64;
+    numBytes -= 64;
+
+    // four independent 128 bit accumulators, each of them skips 512 bits
+    static constexpr uint64_t Fold64Low  = foldLow (512);
+    static constexpr uint64_t Fold64High = foldHigh(512);
+    __m128i fold64 = _mm_set_epi64x((long long) Fold64High, (long long) Fold64Low);
+    while (numBytes >= 64)
+    {
+      x0 = fold(x0, fold64, loadBlock(data +  0));
+      x1 = fold(x1, fold64, loadBlock(data + 16));
+      x2 = fold(x2, fold64, loadBlock(data + 32));
+      x3 = fold(x3, fold64, loadBlock(data + 48));
+      data     += 64;
+      numBytes -= 64;
+    }
+
+    // merge accumulators
+    static constexpr uint64_t Fold16Low  = foldLow (128);
+    static constexpr uint64_t Fold16High = foldHigh(128);
+    __m128i fold16 = _mm_set_epi64x((long long) Fold16High, (long long) Fold16Low);
+    __m128i x = fold(x0, fold16, x1);
+    x = fold(x, fold16, x2);
+    x = fold(x, fold16, x3);
+
+    while (numBytes >= 16)
+    {
+      x = fold(x, fold16, loadBlock(data));
+      data     += 16;
+      numBytes -= 16;
+    }
+
+    // x is a 16 byte message with the same CRC as all data processed so far
+    if (!Reflected)
+      x = _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    uint8_t remainder[16];
+    _mm_storeu_si128((__m128i*)remainder, x);
+    crc = slicing8(remainder, 16, 0);
+
+    // remaining 0 to 15 bytes
+    return slicing8(data, numBytes, crc);
+  }
+#endif
+
+  /// hash (before the final XOR)
+  uint64_t m_hash;
+};
+
+/// definition of the compile-time tables (still needed in C++11)
+template <unsigned int Width, uint64_t Polynomial, bool Reflected, uint64_t Init, uint64_t XorOut>
+constexpr typename CRC<Width, Polynomial, Reflected, Init, XorOut>::Lookup CRC<Width, Polynomial, Reflected, Init, XorOut>::lookup;
+
+
+/// CRC-32/BZIP2, also used by AAL5 and DECT
+typedef CRC<32, 0x04C11DB7, false, 0xFFFFFFFF, 0xFFFFFFFF> CRC32_BZIP2;
+/// CRC-32K (Koopman polynomial), better Hamming distance than CRC32 for messages up to a few KB
+typedef CRC<32, 0x741B8CD7, true,  0xFFFFFFFF, 0xFFFFFFFF> CRC32K;
+/// CRC-16/ARC, often just called CRC-16 (Modbus uses a different initial value)
+typedef CRC<16, 0x8005,     true,  0,          0>          CRC16;
+/// CRC-16/IBM-3740, widely known as CRC-16/CCITT-FALSE
+typedef CRC<16, 0x1021,     false, 0xFFFF,     0>          CRC16_CCITT;
@@ -5,15 +5,29 @@
 //
 
 #include "crc32.h"
+#include "threadpool.h"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
 #include <endian.h>
 #endif
 
+#include <vector>
+#include <cstring> // memcpy
 
-/// same as reset()
-CRC32::CRC32()
+// uncomment to replace Slicing-by-8 by a kernel without look-up tables (shifts and XORs only, no data cache footprint)
+//#define CRC32_TABLE_FREE
+
+// non-temporal stores need x86 intrinsics
+#if (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)) && (defined(__x86_64__) || defined(_M_X64))
+#define CRC32_NONTEMPORAL
+#include <emmintrin.h>
+#endif
+
+
+/// same as reset(), pool = NULL means single-threaded
+CRC32::CRC32(ThreadPool* pool)
+: m_pool(pool)
 {
   reset();
 }
@@ -22,12 +36,16 @@ CRC32::CRC32()
 /// restart
 void CRC32::reset()
 {
-  m_hash = 0;
+  m_hash     = 0;
+  m_numBytes = 0;
 }
 
 
 namespace
 {
+  /// reflected polynomial, bit 31 stands for x^0
+  const uint32_t Polynomial = 0xEDB88320;
+
   /// look-up table
   static const uint32_t crc32Lookup[8][256] =
   {
@@ -332,22 +350,77 @@ namespace
           ((x <<  8) & 0x00FF0000) |
            (x << 24);
   }
-}
 
+  /// multiply a * b modulo the CRC polynomial (both reflected)
+  uint32_t multiplyModulo(uint32_t a, uint32_t b)
+  {
+    uint32_t result = 0;
+    for (uint32_t mask = 1U << 31; mask != 0; mask >>= 1)
+    {
+      if (a & mask)
+      {
+        result ^= b;
+        // no higher bits left ?
+        if ((a & (mask - 1)) == 0)
+          break;
+      }
+      // b *= x
+      b = (b >> 1) ^ ((b & 1) * Polynomial);
+    }
+    return result;
+  }
 
-/// add arbitrary number of bytes
-void CRC32::add(const void* data, size_t numBytes)
-{
-  uint32_t* current = (uint32_t*) data;
-  uint32_t crc = ~m_hash;
+  /// x^(2^i) modulo the CRC polynomial (reflected), repeats after 32 entries because x^(2^32) = x
+  const uint32_t powersOfX[32] =
+  {
+    // generated by:
+    //powersOfX[0] = 1 << 30; // x^1
+    //for (unsigned int i = 1; i < 32; i++)
+    //  powersOfX[i] = multiplyModulo(powersOfX[i - 1], powersOfX[i - 1]);
+    0x40000000, 0x20000000, 0x08000000, 0x00800000, 0x00008000, 0xEDB88320, 0xB1E6B092, 0xA06A2517,
+    0xED627DAE, 0x88D14467, 0xD7BBFE6A, 0xEC447F11, 0x8E7EA170, 0x6427800E, 0x4D47BAE0, 0x09FE548F,
+    0x83852D0F, 0x30362F1A, 0x7B5A9CC3, 0x31FEC169, 0x9FEC022A, 0x6C8DEDC4, 0x15D6874D, 0x5FDE7A4E,
+    0xBAD90E37, 0x2E4E5EEF, 0x4EABA214, 0xA8A472C0, 0x429A969E, 0x148D302A, 0xC40BA6D0, 0xC4E22C3C
+  };
 
-  // process eight bytes at once
-  while (numBytes >= 8)
+  /// compute x^(8 * numBytes) modulo the CRC polynomial, needs O(log numBytes) multiplications
+  uint32_t powerOfX(uint64_t numBytes)
   {
+    // x^0
+    uint32_t result = 1U << 31;
+    // 8 * numBytes => start with x^(2^3)
+    for (unsigned int i = 3; numBytes != 0; i++, numBytes >>= 1)
+      if (numBytes & 1)
+        result = multiplyModulo(result, powersOfX[i % 32]);
+    return result;
+  }
+
+  /// x^(8*Quarter-33), x^(16*Quarter-33) and x^(24*Quarter-33) modulo the CRC polynomial (reflected) with Quarter = PageSize / 4
+  template <size_t PageSize> struct PageConstants;
+  template <> struct PageConstants<  512> { static const uint32_t One = 0x910EEEC1, Two = 0xE95C1271, Three = 0xD31343EA; };
+  template <> struct PageConstants< 4096> { static const uint32_t One = 0xBBF2F6D6, Two = 0x7B4AA8B7, Three = 0xA0DECEF3; };
+  template <> struct PageConstants< 8192> { static const uint32_t One = 0x7B4AA8B7, Two = 0x68C0A2C5, Three = 0xCEA114A5; };
+  template <> struct PageConstants<16384> { static const uint32_t One = 0x68C0A2C5, Two = 0x2339D155, Three = 0x4470C029; };
+
+  /// carry-less product of two reflected 32 bit values, the 64 bit result is reflected, too, and has an extra factor x
+  inline uint64_t multiplyCarryless(uint32_t a, uint32_t b)
+  {
+    // no dependencies between iterations, unlike multiplyModulo
+    uint64_t result = 0;
+    for (int i = 0; i < 32; i++)
+      result ^= ((uint64_t)b << i) & (0 - (uint64_t)((a >> i) & 1));
+    return result;
+  }
+
+  /// process eight bytes with slicing-by-8
+  inline uint32_t slicing8(uint32_t crc, const uint8_t* source)
+  {
+    uint32_t one, two;
+    memcpy(&one, source,     4);
+    memcpy(&two, source + 4, 4);
 #if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
-    uint32_t one = *current++ ^ swap(crc);
-    uint32_t two = *current++;
-    crc  = crc32Lookup[7][ one>>24        ] ^
+    one ^= swap(crc);
+    return crc32Lookup[7][ one>>24        ] ^
            crc32Lookup[6][(one>>16) & 0xFF] ^
            crc32Lookup[5][(one>> 8) & 0xFF] ^
            crc32Lookup[4][ one      & 0xFF] ^
@@ -356,9 +429,8 @@ void CRC32::add(const void* data, size_t numBytes)
            crc32Lookup[1][(two>> 8) & 0xFF] ^
            crc32Lookup[0][ two      & 0xFF];
 #else
-    uint32_t one = *current++ ^ crc;
-    uint32_t two = *current++;
-    crc  = crc32Lookup[7][ one      & 0xFF] ^
+    one ^= crc;
+    return crc32Lookup[7][ one      & 0xFF] ^
            crc32Lookup[6][(one>> 8) & 0xFF] ^
            crc32Lookup[5][(one>>16) & 0xFF] ^
            crc32Lookup[4][ one>>24        ] ^
@@ -367,15 +439,411 @@ void CRC32::add(const void* data, size_t numBytes)
            crc32Lookup[1][(two>>16) & 0xFF] ^
            crc32Lookup[0][ two>>24        ];
 #endif
-    numBytes -= 8;
   }
 
-  unsigned char* currentChar = (unsigned char*) current;
-  // remaining 1 to 7 bytes (standard CRC table-based algorithm)
-  while (numBytes--)
-    crc = (crc >> 8) ^ crc32Lookup[0][(crc & 0xFF) ^ *currentChar++];
+  /// value * x^32 modulo the CRC polynomial (reflected), same as the CRC of value's eight bytes with an empty CRC register
+  inline uint32_t reduce(uint64_t value)
+  {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++)
+      bytes[i] = (uint8_t)(value >> (8 * i));
+    return slicing8(0, bytes);
+  }
+
+  /// process four independent streams in parallel (numBytes must be a multiple of 8), crc contains raw CRC registers
+  void slicing8x4(const uint8_t* current[4], size_t numBytes, uint32_t crc[4])
+  {
+    uint32_t crc0 = crc[0], crc1 = crc[1], crc2 = crc[2], crc3 = crc[3];
+    for (size_t i = 0; i < numBytes; i += 8)
+    {
+      crc0 = slicing8(crc0, current[0] + i);
+      crc1 = slicing8(crc1, current[1] + i);
+      crc2 = slicing8(crc2, current[2] + i);
+      crc3 = slicing8(crc3, current[3] + i);
+    }
+    crc[0] = crc0; crc[1] = crc1; crc[2] = crc2; crc[3] = crc3;
+  }
+
+  /// write eight bytes, optionally bypassing the cache
+  template <bool NonTemporal>
+  inline void store(uint8_t* destination, const uint8_t* source)
+  {
+#ifdef CRC32_NONTEMPORAL
+    if (NonTemporal)
+    {
+      long long value;
+      memcpy(&value, source, 8);
+      _mm_stream_si64((long long*) destination, value);
+      return;
+    }
+#endif
+    memcpy(destination, source, 8);
+  }
+
+  /// slicing-by-8, continue with previousCrc32, optionally copy all bytes to destination
+  template <bool Copy, bool NonTemporal>
+  uint32_t crc32Slicing8(uint8_t* destination, const uint8_t* source, size_t numBytes, uint32_t previousCrc32)
+  {
+    uint32_t crc = ~previousCrc32;
+
+    // non-temporal stores must be aligned
+    while (NonTemporal && numBytes > 0 && ((size_t)destination & 7) != 0)
+    {
+      *destination++ = *source;
+      crc = (crc >> 8) ^ crc32Lookup[0][(crc & 0xFF) ^ *source++];
+      numBytes--;
+    }
+
+    // process eight bytes at once
+    while (numBytes >= 8)
+    {
+      if (Copy)
+      {
+        store<NonTemporal>(destination, source);
+        destination += 8;
+      }
+      crc = slicing8(crc, source);
+      source   += 8;
+      numBytes -= 8;
+    }
+
+    // remaining 1 to 7 bytes (standard CRC table-based algorithm)
+    while (numBytes--)
+    {
+      if (Copy)
+        *destination++ = *source;
+      crc = (crc >> 8) ^ crc32Lookup[0][(crc & 0xFF) ^ *source++];
+    }
+
+#ifdef CRC32_NONTEMPORAL
+    if (NonTemporal)
+      _mm_sfence();
+#endif
+
+    return ~crc;
+  }
+
+  /// same as crc32Lookup[0][value & 0xFF], but combined from the CRCs of single bits => no memory access
+  inline uint32_t tableFreeByte(uint32_t value)
+  {
+    return (0x77073096 & (0 - ( value       & 1))) ^
+           (0xEE0E612C & (0 - ((value >> 1) & 1))) ^
+           (0x076DC419 & (0 - ((value >> 2) & 1))) ^
+           (0x0EDB8832 & (0 - ((value >> 3) & 1))) ^
+           (0x1DB71064 & (0 - ((value >> 4) & 1))) ^
+           (0x3B6E20C8 & (0 - ((value >> 5) & 1))) ^
+           (0x76DC4190 & (0 - ((value >> 6) & 1))) ^
+           (0xEDB88320 & (0 - ((value >> 7) & 1)));
+  }
+
+  /// read eight bytes as little endian
+  inline uint64_t loadLittleEndian(const uint8_t* source)
+  {
+    uint32_t one, two;
+    memcpy(&one, source,     4);
+    memcpy(&two, source + 4, 4);
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+    one = swap(one);
+    two = swap(two);
+#endif
+    return ((uint64_t)two << 32) | one;
+  }
+
+  /// shifts and XORs only, continue with previousCrc32
+  /** The CRC polynomial divides the sparse polynomial x^300 + x^155 + x^117 + x^89 + 1 (found by a computer search).
+      Therefore a set bit at position p of the input (bit 0 of the first byte is position 0) leaves the same remainder
+      as flipping the bits at p+145, p+183, p+211 and p+300 instead.
+      Each 64 bit word is pushed forward this way until only 40 bytes are left, which are processed byte-wise.
+      Same idea as Sam Russell's Chorba algorithm. */
+  uint32_t crc32TableFree(const uint8_t* source, size_t numBytes, uint32_t previousCrc32)
+  {
+    uint32_t crc = ~previousCrc32;
+
+    // each word affects the next five words
+    if (numBytes >= 48)
+    {
+      // bits flipped in the current and the next four words, the CRC register affects the first four bytes
+      uint64_t next0 = crc, next1 = 0, next2 = 0, next3 = 0, next4 = 0;
+      while (numBytes >= 48)
+      {
+        uint64_t word = loadLittleEndian(source) ^ next0;
+        // 145 = 2*64 + 17, 183 = 2*64 + 55, 211 = 3*64 + 19, 300 = 4*64 + 44
+        next0 = next1;
+        next1 = next2 ^ (word << 17) ^ (word << 55);
+        next2 = next3 ^ (word >> 47) ^ (word >>  9) ^ (word << 19);
+        next3 = next4 ^ (word >> 45) ^ (word << 44);
+        next4 =          word >> 20;
+
+        source   += 8;
+        numBytes -= 8;
+      }
+
+      // apply flipped bits to the remaining five words
+      uint64_t next[5] = { next0, next1, next2, next3, next4 };
+      uint8_t  remaining[40];
+      for (int i = 0; i < 40; i++)
+        remaining[i] = source[i] ^ (uint8_t)(next[i / 8] >> (8 * (i % 8)));
+      source   += 40;
+      numBytes -= 40;
+
+      // the CRC register was already merged into the data
+      crc = 0;
+      for (int i = 0; i < 40; i++)
+        crc = (crc >> 8) ^ tableFreeByte(crc ^ remaining[i]);
+    }
+
+    // remaining 0 to 47 bytes
+    while (numBytes--)
+      crc = (crc >> 8) ^ tableFreeByte(crc ^ *source++);
+
+    return ~crc;
+  }
+
+  /// software kernel used by CRC32::add
+  inline uint32_t crc32Software(const uint8_t* source, size_t numBytes, uint32_t previousCrc32)
+  {
+#ifdef CRC32_TABLE_FREE
+    return crc32TableFree(source, numBytes, previousCrc32);
+#else
+    return crc32Slicing8<false, false>(NULL, source, numBytes, previousCrc32);
+#endif
+  }
+}
+
+
+/// add arbitrary number of bytes
+void CRC32::add(const void* data, size_t numBytes)
+{
+  m_numBytes += numBytes;
+
+  // split into equally-sized blocks, compute their CRC32 in parallel and merge them
+  if (m_pool != NULL && numBytes >= 2 * MinBytesPerTask)
+  {
+    size_t numTasks = numBytes / MinBytesPerTask;
+    size_t maxTasks = 4 * m_pool->getNumThreads();
+    if (numTasks > maxTasks)
+      numTasks = maxTasks;
+    size_t bytesPerTask = numBytes / numTasks;
+
+    const unsigned char* current = (const unsigned char*) data;
+    std::vector<uint32_t> crcs(numTasks);
+    m_pool->run(numTasks, [&](size_t task)
+    {
+      // last task processes a few more bytes if numBytes isn't a multiple of numTasks
+      size_t length = task + 1 < numTasks ? bytesPerTask : numBytes - task * bytesPerTask;
+      crcs[task] = crc32Software(current + task * bytesPerTask, length, 0);
+    });
+
+    for (size_t i = 0; i + 1 < numTasks; i++)
+      m_hash = crc32_combine(m_hash, crcs[i], bytesPerTask);
+    m_hash = crc32_combine(m_hash, crcs[numTasks - 1], numBytes - (numTasks - 1) * bytesPerTask);
+    return;
+  }
+
+  m_hash = crc32Software((const uint8_t*) data, numBytes, m_hash);
+}
+
+
+/// add numBytes zeros, much faster than add() because it needs only O(log numBytes) steps
+void CRC32::addZeros(uint64_t numBytes)
+{
+  // zeros don't flip any bits, they only shift the CRC by 8 * numBytes bits
+  m_hash      = ~multiplyModulo(powerOfX(numBytes), ~m_hash);
+  m_numBytes += numBytes;
+}
+
+
+/// update CRC32 after numBytes at offset changed from oldData to newData, O(numBytes + log getNumBytes())
+void CRC32::patch(uint64_t offset, const void* oldData, const void* newData, size_t numBytes)
+{
+  m_hash = crc32_patch(m_hash, m_numBytes, offset, oldData, newData, numBytes);
+}
+
+
+/// update CRC32 of a block of totalLength bytes after numBytes at offset changed from oldData to newData
+uint32_t crc32_patch(uint32_t crc, uint64_t totalLength, uint64_t offset,
+                     const void* oldData, const void* newData, size_t numBytes)
+{
+  // the changed bytes must be part of the block, else the CRC stays unchanged
+  if (offset > totalLength || numBytes > totalLength - offset)
+    return crc;
+
+  // CRC is linear: CRC(new) = CRC(old) ^ CRC'(old ^ new) where CRC' has neither initial nor final bit flips.
+  // old ^ new is zero except for the changed bytes, leading zeros don't affect CRC' at all
+  // and trailing zeros shift it by 8 * (totalLength - offset - numBytes) bits.
+  // Besides, CRC'(old ^ new) = CRC'(old) ^ CRC'(new) so that no temporary buffer is needed.
+  // An initial value of ~0 cancels crc32Slicing8's initial bit flip, the final one is undone by ~.
+  uint32_t oldCrc = ~crc32Slicing8<false, false>(NULL, (const uint8_t*) oldData, numBytes, 0xFFFFFFFF);
+  uint32_t newCrc = ~crc32Slicing8<false, false>(NULL, (const uint8_t*) newData, numBytes, 0xFFFFFFFF);
+  uint64_t trailing = totalLength - offset - numBytes;
+  return crc ^ multiplyModulo(powerOfX(trailing), oldCrc ^ newCrc);
+}
+
+
+/// copy numBytes from source to destination and return their CRC32 (continue with previousCrc32)
+uint32_t copy_and_crc32(void* destination, const void* source, size_t numBytes, uint32_t previousCrc32, bool nonTemporal)
+{
+  uint8_t*       to   = (uint8_t*)       destination;
+  const uint8_t* from = (const uint8_t*) source;
+  return nonTemporal ? crc32Slicing8<true, true >(to, from, numBytes, previousCrc32)
+                     : crc32Slicing8<true, false>(to, from, numBytes, previousCrc32);
+}
+
+
+/// compute CRC32 of a page with a fixed size (continue with previousCrc32)
+template <size_t PageSize>
+uint32_t crc32_page(const void* page, uint32_t previousCrc32)
+{
+#ifdef CRC32_TABLE_FREE
+  // no look-up tables, no parallel streams: splitting wouldn't pay off
+  return crc32TableFree((const uint8_t*) page, PageSize, previousCrc32);
+#else
+  // split into four quarters which are processed in parallel
+  const size_t Quarter = PageSize / 4;
+  const uint8_t* current[4] = { (const uint8_t*) page, current[0] + Quarter, current[1] + Quarter, current[2] + Quarter };
+  // raw CRC registers, only the first quarter starts with previousCrc32
+  uint32_t crc[4] = { ~previousCrc32, 0, 0, 0 };
+  slicing8x4(current, Quarter, crc);
+
+  // same as crc32_combine but with precomputed powers of x: crc[i] * x^(8 * distance) = reduce(crc[i] * x^(8 * distance - 33) * x)
+  typedef PageConstants<PageSize> Shift;
+  uint64_t merged = multiplyCarryless(crc[0], Shift::Three) ^
+                    multiplyCarryless(crc[1], Shift::Two)   ^
+                    multiplyCarryless(crc[2], Shift::One);
+  return ~(reduce(merged) ^ crc[3]);
+#endif
+}
+
+// only these page sizes are supported
+template uint32_t crc32_page<  512>(const void* page, uint32_t previousCrc32);
+template uint32_t crc32_page< 4096>(const void* page, uint32_t previousCrc32);
+template uint32_t crc32_page< 8192>(const void* page, uint32_t previousCrc32);
+template uint32_t crc32_page<16384>(const void* page, uint32_t previousCrc32);
+
+
+/// compute CRC32 without any look-up tables (continue with previousCrc32)
+uint32_t crc32_tablefree(const void* data, size_t numBytes, uint32_t previousCrc32)
+{
+  return crc32TableFree((const uint8_t*) data, numBytes, previousCrc32);
+}
+
+
+/// compute CRC32 of numBuffers independent buffers: crcs[i] = CRC32(data[i], numBytes[i])
+void crc32_batch(const void* const data[], const size_t numBytes[], size_t numBuffers, uint32_t crcs[])
+{
+  // four streams are interleaved so that their table lookups overlap
+  const size_t NumLanes = 4;
+
+  // each lane processes one buffer, as soon as it's finished the lane continues with the next buffer
+  const uint8_t* current  [NumLanes];
+  size_t         remaining[NumLanes];
+  size_t         index    [NumLanes];
+  uint32_t       crc      [NumLanes];
+  bool           active   [NumLanes];
+  size_t next = 0;
+  for (size_t lane = 0; lane < NumLanes; lane++)
+  {
+    active[lane] = next < numBuffers;
+    if (!active[lane])
+      continue;
+    current  [lane] = (const uint8_t*) data[next];
+    remaining[lane] = numBytes[next];
+    index    [lane] = next++;
+    crc      [lane] = 0xFFFFFFFF; // initial bit flip
+  }
+
+  // interleave all lanes until there are no more buffers to fill the lanes
+  bool allActive = numBuffers >= NumLanes;
+  while (allActive)
+  {
+    // process as many bytes as the shortest buffer has left (multiple of 8)
+    size_t step = remaining[0];
+    for (size_t lane = 1; lane < NumLanes; lane++)
+      if (step > remaining[lane])
+        step = remaining[lane];
+    step &= ~size_t(7);
+
+    slicing8x4(current, step, crc);
+
+    for (size_t lane = 0; lane < NumLanes; lane++)
+    {
+      current  [lane] += step;
+      remaining[lane] -= step;
+      if (remaining[lane] >= 8)
+        continue;
+
+      // finish with remaining 0 to 7 bytes and switch to next buffer
+      crcs[index[lane]] = crc32Slicing8<false, false>(NULL, current[lane], remaining[lane], ~crc[lane]);
+      if (next == numBuffers)
+      {
+        active[lane] = false;
+        allActive    = false;
+        continue;
+      }
+      current  [lane] = (const uint8_t*) data[next];
+      remaining[lane] = numBytes[next];
+      index    [lane] = next++;
+      crc      [lane] = 0xFFFFFFFF;
+    }
+  }
+
+  // finish all buffers one by one
+  for (size_t lane = 0; lane < NumLanes; lane++)
+    if (active[lane])
+      crcs[index[lane]] = crc32Slicing8<false, false>(NULL, current[lane], remaining[lane], ~crc[lane]);
+}
+
+
+/// append another CRC32's data as if it was added to this object, too
+void CRC32::combine(const CRC32& other)
+{
+  m_hash      = crc32_combine(m_hash, other.m_hash, other.m_numBytes);
+  m_numBytes += other.m_numBytes;
+}
+
 
-  m_hash = ~crc;
+/// number of bytes processed so far
+uint64_t CRC32::getNumBytes() const
+{
+  return m_numBytes;
+}
+
+
+/// export internal state: number of bytes and hash (little endian)
+std::string CRC32::getState() const
+{
+  std::string state;
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(m_numBytes >> shift);
+  for (int shift = 0; shift < 32; shift += 8)
+    state += char(m_hash >> shift);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid
+bool CRC32::setState(const std::string& state)
+{
+  if (state.size() != 8 + 4)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  m_numBytes = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    m_numBytes |= uint64_t(*current++) << shift;
+  m_hash = 0;
+  for (int shift = 0; shift < 32; shift += 8)
+    m_hash |= uint32_t(*current++) << shift;
+  return true;
+}
+
+
+/// compute CRC32(A+B) from CRC32(A), CRC32(B) and B's length
+uint32_t crc32_combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB)
+{
+  // appending lengthB bytes shifts A's CRC by 8 * lengthB bits (=> multiply by x^(8 * lengthB) modulo polynomial),
+  // the initial and final bit flips of both CRCs cancel out
+  return multiplyModulo(powerOfX(lengthB), crcA) ^ crcB;
 }
 
 
@@ -14,11 +14,14 @@
 // Windows
 typedef unsigned __int8  uint8_t;
 typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
 #else
 // GCC
 #include <stdint.h>
 #endif
 
+class ThreadPool;
+
 
 /// compute CRC32 hash, based on Intel's Slicing-by-8 algorithm
 /** Usage:
@@ -33,6 +36,23 @@ typedef unsigned __int32 uint32_t;
       crc32.add(pointer to fresh data, number of new bytes);
     std::string myHash3 = crc32.getHash();
 
+    // or hash chunks independently (e.g. on different threads) and merge them:
+
+    CRC32 first, second;
+    first .add(pointer to first  part, number of bytes);
+    second.add(pointer to second part, number of bytes);
+    first.combine(second);  // same as if both parts were added to first
+    std::string myHash4 = first.getHash();
+
+    // large blocks can be split across all CPU cores:
+
+    CRC32 crc32(&ThreadPool::shared());
+    std::string myHash5 = crc32(pointer to huge block, number of bytes);
+
+    // a few bytes of an already hashed block changed ? no need to hash the whole block again:
+
+    crc32.patch(offset, pointer to old bytes, pointer to new bytes, number of changed bytes);
+
     Note:
     You can find code for the faster Slicing-by-16 algorithm on my website, too:
     http://create.stephan-brumme.com/crc32/
@@ -44,8 +64,8 @@ public:
   /// hash is 4 bytes long
   enum { HashBytes = 4 };
 
-  /// same as reset()
-  CRC32();
+  /// same as reset(), pool = NULL means single-threaded
+  explicit CRC32(ThreadPool* pool = NULL);
 
   /// compute CRC32 of a memory block
   std::string operator()(const void* data, size_t numBytes);
@@ -54,6 +74,8 @@ public:
 
   /// add arbitrary number of bytes
   void add(const void* data, size_t numBytes);
+  /// add numBytes zeros, much faster than add() because it needs only O(log numBytes) steps
+  void addZeros(uint64_t numBytes);
 
   /// return latest hash as 8 hex characters
   std::string getHash();
@@ -63,7 +85,64 @@ public:
   /// restart
   void reset();
 
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
+  /// append another CRC32's data as if it was added to this object, too
+  void combine(const CRC32& other);
+  /// number of bytes processed so far
+  uint64_t getNumBytes() const;
+
+  /// update CRC32 after numBytes at offset changed from oldData to newData, O(numBytes + log getNumBytes())
+  /** Nothing happens if offset + numBytes is beyond getNumBytes(). */
+  void patch(uint64_t offset, const void* oldData, const void* newData, size_t numBytes);
+
 private:
+  /// split large blocks into tasks of at least 1 MB
+  enum { MinBytesPerTask = 1024 * 1024 };
+
+  /// workers (NULL if single-threaded)
+  ThreadPool* m_pool;
   /// hash
   uint32_t m_hash;
+  /// size of processed data in bytes
+  uint64_t m_numBytes;
 };
+
+
+/// compute CRC32(A+B) from CRC32(A), CRC32(B) and B's length (same parameters as zlib's crc32_combine)
+/** Requires O(log lengthB) operations, the length of A is irrelevant. */
+uint32_t crc32_combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB);
+
+/// update CRC32 of a block of totalLength bytes after numBytes at offset changed from oldData to newData
+/** Only the changed bytes are processed: O(numBytes + log totalLength).
+    Returns crc unchanged if the changed bytes aren't completely inside the block. */
+uint32_t crc32_patch(uint32_t crc, uint64_t totalLength, uint64_t offset,
+                     const void* oldData, const void* newData, size_t numBytes);
+
+/// copy numBytes from source to destination and return their CRC32 (continue with previousCrc32)
+/** Both happen in a single pass so that the source is read only once.
+    nonTemporal = true bypasses the CPU cache when writing to destination (x86-64 only),
+    which is faster for large copies if destination isn't read soon.
+    Source and destination must not overlap. */
+uint32_t copy_and_crc32(void* destination, const void* source, size_t numBytes,
+                        uint32_t previousCrc32 = 0, bool nonTemporal = false);
+
+/// compute CRC32 of a page with a fixed size (continue with previousCrc32)
+/** Only PageSize = 512, 4096, 8192 and 16384 are available.
+    Its four quarters are hashed in parallel and merged with precomputed constants, no loop has to handle a tail. */
+template <size_t PageSize>
+uint32_t crc32_page(const void* page, uint32_t previousCrc32 = 0);
+
+/// compute CRC32 without any look-up tables (continue with previousCrc32)
+/** Only shifts and XORs: almost as fast as Slicing-by-8 for large blocks but without its 8 KB of tables,
+    which would compete with other code for the L1 cache.
+    CRC32::add uses this algorithm, too, if crc32.cpp is compiled with CRC32_TABLE_FREE. */
+uint32_t crc32_tablefree(const void* data, size_t numBytes, uint32_t previousCrc32 = 0);
+
+/// compute CRC32 of numBuffers independent buffers: crcs[i] = CRC32(data[i], numBytes[i])
+/** Four buffers are processed in parallel, which is much faster than hashing them one after another
+    if they are small (e.g. network packets). */
+void crc32_batch(const void* const data[], const size_t numBytes[], size_t numBuffers, uint32_t crcs[]);
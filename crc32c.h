@@ -0,0 +1,91 @@
+// //////////////////////////////////////////////////////////
+// crc32c.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// compute CRC32C hash (Castagnoli polynomial, used by iSCSI, ext4, Btrfs, SCTP, ...)
+/** Usage:
+    CRC32C crc32c;
+    std::string myHash  = crc32c("Hello World");     // std::string
+    std::string myHash2 = crc32c("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    CRC32C crc32c;
+    while (more data available)
+      crc32c.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = crc32c.getHash();
+
+    Note:
+    x86 CPUs with SSE4.2 have a crc32 instruction which is used if available (GCC and Clang only),
+    else a Slicing-by-8 algorithm is used (same as class CRC32 but with a different polynomial).
+  */
+class CRC32C //: public Hash
+{
+public:
+  /// hash is 4 bytes long
+  enum { HashBytes = 4 };
+
+  /// same as reset()
+  CRC32C();
+
+  /// compute CRC32C of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute CRC32C of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 8 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+  /// name of the algorithm chosen at runtime ("sse4.2" or "slicing-by-8")
+  static const char* getImplementation();
+
+private:
+  /// hash
+  uint32_t m_hash;
+};
+
+
+/// copy numBytes from source to destination and return their CRC32C (continue with previousCrc32c)
+/** Both happen in a single pass so that the source is read only once.
+    nonTemporal = true bypasses the CPU cache when writing to destination (x86 only),
+    which is faster for large copies if destination isn't read soon.
+    Source and destination must not overlap. */
+uint32_t copy_and_crc32c(void* destination, const void* source, size_t numBytes,
+                         uint32_t previousCrc32c = 0, bool nonTemporal = false);
+
+/// compute CRC32C of a page with a fixed size (continue with previousCrc32c)
+/** Only PageSize = 512, 4096, 8192 and 16384 are available.
+    Its four quarters are hashed in parallel and merged with precomputed constants, no loop has to handle a tail. */
+template <size_t PageSize>
+uint32_t crc32c_page(const void* page, uint32_t previousCrc32c = 0);
+
+/// compute CRC32C of numBuffers independent buffers: crcs[i] = CRC32C(data[i], numBytes[i])
+/** Four buffers are processed in parallel, which is much faster than hashing them one after another
+    if they are small (e.g. network packets). */
+void crc32c_batch(const void* const data[], const size_t numBytes[], size_t numBuffers, uint32_t crcs[]);
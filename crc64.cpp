@@ -0,0 +1,380 @@
+// //////////////////////////////////////////////////////////
+// crc64.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "crc64.h"
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#include <cstring> // memcpy
+
+// carry-less multiplication needs GCC's / Clang's x86 intrinsics and target attributes
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CRC64_PCLMUL
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+
+/// same as reset()
+CRC64::CRC64(Polynomial polynomial)
+: m_polynomial(polynomial)
+{
+  reset();
+}
+
+
+/// restart
+void CRC64::reset()
+{
+  m_hash     = 0;
+  m_numBytes = 0;
+}
+
+
+namespace
+{
+  /// multiply a * b modulo the CRC polynomial (all reflected, bit 63 stands for x^0)
+  uint64_t multiplyModulo(uint64_t a, uint64_t b, uint64_t polynomial)
+  {
+    uint64_t result = 0;
+    for (uint64_t mask = 1ULL << 63; mask != 0; mask >>= 1)
+    {
+      if (a & mask)
+      {
+        result ^= b;
+        // no higher bits left ?
+        if ((a & (mask - 1)) == 0)
+          break;
+      }
+      // b *= x
+      b = (b >> 1) ^ ((b & 1) * polynomial);
+    }
+    return result;
+  }
+
+  /// x^exponent modulo the CRC polynomial (reflected), only for small exponents
+  uint64_t powerOfXSlow(unsigned int exponent, uint64_t polynomial)
+  {
+    // x^0
+    uint64_t result = 1ULL << 63;
+    while (exponent--)
+      result = (result >> 1) ^ ((result & 1) * polynomial);
+    return result;
+  }
+
+  /// look-up tables and folding constants of a polynomial
+  struct Tables
+  {
+    /// reflected polynomial
+    uint64_t polynomial;
+    /// slicing-by-8
+    uint64_t lookup[8][256];
+    /// x^(2^i) modulo polynomial, needed by crc64_combine
+    uint64_t powersOfX[64 + 3];
+    /// x^(128+63) and x^(128-1) modulo polynomial: fold 16 bytes into the next 16 bytes
+    uint64_t fold16[2];
+    /// x^(512+63) and x^(512-1) modulo polynomial: fold 64 bytes into the next 64 bytes
+    uint64_t fold64[2];
+
+    explicit Tables(uint64_t reflectedPolynomial)
+    : polynomial(reflectedPolynomial)
+    {
+      // same algorithm as crc32Lookup in crc32.cpp
+      for (unsigned int i = 0; i <= 0xFF; i++)
+      {
+        uint64_t crc = i;
+        for (unsigned int j = 0; j < 8; j++)
+          crc = (crc >> 1) ^ ((crc & 1) * polynomial);
+        lookup[0][i] = crc;
+      }
+      for (unsigned int i = 0; i <= 0xFF; i++)
+        for (unsigned int slice = 1; slice < 8; slice++)
+          lookup[slice][i] = (lookup[slice - 1][i] >> 8) ^ lookup[0][lookup[slice - 1][i] & 0xFF];
+
+      // x^1
+      powersOfX[0] = 1ULL << 62;
+      for (unsigned int i = 1; i < 64 + 3; i++)
+        powersOfX[i] = multiplyModulo(powersOfX[i - 1], powersOfX[i - 1], polynomial);
+
+      // a carry-less product of two reflected 64 bit values is off by one bit => exponents are reduced by one
+      fold16[0] = powerOfXSlow(128 + 63, polynomial);
+      fold16[1] = powerOfXSlow(128 -  1, polynomial);
+      fold64[0] = powerOfXSlow(512 + 63, polynomial);
+      fold64[1] = powerOfXSlow(512 -  1, polynomial);
+    }
+  };
+
+  /// generated on first use
+  const Tables& getTables(CRC64::Polynomial polynomial)
+  {
+    if (polynomial == CRC64::Nvme)
+    {
+      static const Tables nvme(0x9A6C9329AC4BC9B5ULL);
+      return nvme;
+    }
+    static const Tables ecma182(0xC96C5795D7870F42ULL);
+    return ecma182;
+  }
+
+  /// compute x^(8 * numBytes) modulo the CRC polynomial, needs O(log numBytes) multiplications
+  uint64_t powerOfX(uint64_t numBytes, const Tables& tables)
+  {
+    // x^0
+    uint64_t result = 1ULL << 63;
+    // 8 * numBytes => start with x^(2^3)
+    for (unsigned int i = 3; numBytes != 0; i++, numBytes >>= 1)
+      if (numBytes & 1)
+        result = multiplyModulo(result, tables.powersOfX[i], tables.polynomial);
+    return result;
+  }
+
+  /// read eight bytes as little endian
+  inline uint64_t load(const uint8_t* data)
+  {
+    uint64_t value;
+    memcpy(&value, data, 8);
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+#if defined(__GNUC__) || defined(__clang__)
+    value = __builtin_bswap64(value);
+#else
+    value = (value >> 56) | ((value >> 40) & 0xFF00) | ((value >> 24) & 0xFF0000) | ((value >> 8) & 0xFF000000) |
+            ((value & 0xFF000000) << 8) | ((value & 0xFF0000) << 24) | ((value & 0xFF00) << 40) | (value << 56);
+#endif
+#endif
+    return value;
+  }
+
+  /// slicing-by-8, crc is the raw CRC register (without initial / final bit flips)
+  uint64_t crc64Slicing8(const Tables& tables, const uint8_t* data, size_t numBytes, uint64_t crc)
+  {
+    const uint64_t (*lookup)[256] = tables.lookup;
+
+    // process eight bytes at once
+    while (numBytes >= 8)
+    {
+      uint64_t value = load(data) ^ crc;
+      crc = lookup[7][ value        & 0xFF] ^
+            lookup[6][(value >>  8) & 0xFF] ^
+            lookup[5][(value >> 16) & 0xFF] ^
+            lookup[4][(value >> 24) & 0xFF] ^
+            lookup[3][(value >> 32) & 0xFF] ^
+            lookup[2][(value >> 40) & 0xFF] ^
+            lookup[1][(value >> 48) & 0xFF] ^
+            lookup[0][ value >> 56        ];
+      data     += 8;
+      numBytes -= 8;
+    }
+
+    // remaining 1 to 7 bytes (standard CRC table-based algorithm)
+    while (numBytes--)
+      crc = (crc >> 8) ^ lookup[0][(crc & 0xFF) ^ *data++];
+
+    return crc;
+  }
+
+#ifdef CRC64_PCLMUL
+  /// multiply both halves of a by the matching folding constant and add b
+  __attribute__((target("pclmul")))
+  inline __m128i fold(__m128i a, __m128i constants, __m128i b)
+  {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(a, constants, 0x00),
+                                       _mm_clmulepi64_si128(a, constants, 0x11)), b);
+  }
+
+  /// carry-less multiplication, crc is the raw CRC register (without initial / final bit flips)
+  __attribute__((target("pclmul")))
+  uint64_t crc64Pclmul(const Tables& tables, const uint8_t* data, size_t numBytes, uint64_t crc)
+  {
+    // short input: not worth the setup
+    if (numBytes < 128)
+      return crc64Slicing8(tables, data, numBytes, crc);
+
+    // the register affects the first eight bytes the same way as XORing it into them
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data +  0)), _mm_cvtsi64_si128((long long) crc));
+    __m128i x1 =               _mm_loadu_si128((const __m128i*)(data + 16));
+    __m128i x2 =               _mm_loadu_si128((const __m128i*)(data + 32));
+    __m128i x3 =               _mm_loadu_si128((const __m128i*)(data + 48));
+    data     += 64;
+    numBytes -= 64;
+
+    // four independent 128 bit accumulators, each of them skips 512 bits
+    __m128i fold64 = _mm_set_epi64x((long long) tables.fold64[1], (long long) tables.fold64[0]);
+    while (numBytes >= 64)
+    {
+      x0 = fold(x0, fold64, _mm_loadu_si128((const __m128i*)(data +  0)));
+      x1 = fold(x1, fold64, _mm_loadu_si128((const __m128i*)(data + 16)));
+      x2 = fold(x2, fold64, _mm_loadu_si128((const __m128i*)(data + 32)));
+      x3 = fold(x3, fold64, _mm_loadu_si128((const __m128i*)(data + 48)));
+      data     += 64;
+      numBytes -= 64;
+    }
+
+    // merge accumulators
+    __m128i fold16 = _mm_set_epi64x((long long) tables.fold16[1], (long long) tables.fold16[0]);
+    __m128i x = fold(x0, fold16, x1);
+    x = fold(x, fold16, x2);
+    x = fold(x, fold16, x3);
+
+    while (numBytes >= 16)
+    {
+      x = fold(x, fold16, _mm_loadu_si128((const __m128i*)data));
+      data     += 16;
+      numBytes -= 16;
+    }
+
+    // x is a 16 byte message with the same CRC as all data processed so far
+    uint8_t remainder[16];
+    _mm_storeu_si128((__m128i*)remainder, x);
+    crc = crc64Slicing8(tables, remainder, 16, 0);
+
+    // remaining 0 to 15 bytes
+    return crc64Slicing8(tables, data, numBytes, crc);
+  }
+#endif
+
+  /// true if the CPU supports carry-less multiplication
+  bool hasPclmul()
+  {
+#ifdef CRC64_PCLMUL
+    struct Detect
+    {
+      static bool run()
+      {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul");
+      }
+    };
+    // checked on first use
+    static const bool supported = Detect::run();
+    return supported;
+#else
+    return false;
+#endif
+  }
+}
+
+
+/// name of the algorithm chosen at runtime ("pclmul" or "slicing-by-8")
+const char* CRC64::getImplementation()
+{
+  return hasPclmul() ? "pclmul" : "slicing-by-8";
+}
+
+
+/// add arbitrary number of bytes
+void CRC64::add(const void* data, size_t numBytes)
+{
+  m_numBytes += numBytes;
+
+  const Tables& tables = getTables(m_polynomial);
+#ifdef CRC64_PCLMUL
+  if (hasPclmul())
+  {
+    m_hash = ~crc64Pclmul(tables, (const uint8_t*) data, numBytes, ~m_hash);
+    return;
+  }
+#endif
+  m_hash = ~crc64Slicing8(tables, (const uint8_t*) data, numBytes, ~m_hash);
+}
+
+
+/// append another CRC64's data as if it was added to this object, too (both must use the same polynomial)
+void CRC64::combine(const CRC64& other)
+{
+  m_hash      = crc64_combine(m_hash, other.m_hash, other.m_numBytes, m_polynomial);
+  m_numBytes += other.m_numBytes;
+}
+
+
+/// number of bytes processed so far
+uint64_t CRC64::getNumBytes() const
+{
+  return m_numBytes;
+}
+
+
+/// export internal state: number of bytes and hash (little endian)
+std::string CRC64::getState() const
+{
+  std::string state;
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(m_numBytes >> shift);
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(m_hash >> shift);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid
+bool CRC64::setState(const std::string& state)
+{
+  if (state.size() != 8 + 8)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  m_numBytes = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    m_numBytes |= uint64_t(*current++) << shift;
+  m_hash = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    m_hash |= uint64_t(*current++) << shift;
+  return true;
+}
+
+
+/// compute CRC64(A+B) from CRC64(A), CRC64(B) and B's length in O(log lengthB)
+uint64_t crc64_combine(uint64_t crcA, uint64_t crcB, uint64_t lengthB, CRC64::Polynomial polynomial)
+{
+  // same as crc32_combine: shift A's CRC by 8 * lengthB bits, the bit flips cancel out
+  const Tables& tables = getTables(polynomial);
+  return multiplyModulo(powerOfX(lengthB, tables), crcA, tables.polynomial) ^ crcB;
+}
+
+
+/// return latest hash as 16 hex characters
+std::string CRC64::getHash()
+{
+  // convert hash to string
+  static const char dec2hex[16+1] = "0123456789abcdef";
+
+  char hashBuffer[16+1];
+  for (int i = 0; i < 16; i++)
+    hashBuffer[i] = dec2hex[(m_hash >> (60 - 4 * i)) & 15];
+  // zero-terminated string
+  hashBuffer[16] = 0;
+
+  // convert to std::string
+  return hashBuffer;
+}
+
+
+/// return latest hash as bytes
+void CRC64::getHash(unsigned char buffer[CRC64::HashBytes])
+{
+  for (int i = 0; i < HashBytes; i++)
+    buffer[i] = (m_hash >> (56 - 8 * i)) & 0xFF;
+}
+
+
+/// compute CRC64 of a memory block
+std::string CRC64::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute CRC64 of a string, excluding final zero
+std::string CRC64::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
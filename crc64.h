@@ -0,0 +1,97 @@
+// //////////////////////////////////////////////////////////
+// crc64.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// compute CRC64 hash (ECMA-182 polynomial as used by XZ or NVMe polynomial)
+/** Usage:
+    CRC64 crc64;
+    std::string myHash  = crc64("Hello World");     // std::string
+    std::string myHash2 = crc64("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    CRC64 crc64(CRC64::Nvme);
+    while (more data available)
+      crc64.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = crc64.getHash();
+
+    Note:
+    x86 CPUs with carry-less multiplication (PCLMULQDQ) fold 64 bytes per iteration (GCC and Clang only),
+    else a Slicing-by-8 algorithm is used. Its look-up tables (16 KB per polynomial) are generated on first use.
+  */
+class CRC64 //: public Hash
+{
+public:
+  /// hash is 8 bytes long
+  enum { HashBytes = 8 };
+
+  /// supported polynomials, both reflected with all bits flipped initially and at the end
+  enum Polynomial
+  {
+    Ecma182, ///< CRC-64/XZ (0x42F0E1EBA9EA3693), used by XZ and 7-Zip
+    Nvme     ///< CRC-64/NVME (0xAD93D23594C93659), used by NVMe end-to-end data protection
+  };
+
+  /// same as reset()
+  explicit CRC64(Polynomial polynomial = Ecma182);
+
+  /// compute CRC64 of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute CRC64 of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 16 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
+  /// append another CRC64's data as if it was added to this object, too (both must use the same polynomial)
+  void combine(const CRC64& other);
+  /// number of bytes processed so far
+  uint64_t getNumBytes() const;
+
+  /// name of the algorithm chosen at runtime ("pclmul" or "slicing-by-8")
+  static const char* getImplementation();
+
+private:
+  /// polynomial
+  Polynomial m_polynomial;
+  /// hash
+  uint64_t   m_hash;
+  /// size of processed data in bytes
+  uint64_t   m_numBytes;
+};
+
+
+/// compute CRC64(A+B) from CRC64(A), CRC64(B) and B's length in O(log lengthB)
+uint64_t crc64_combine(uint64_t crcA, uint64_t crcB, uint64_t lengthB, CRC64::Polynomial polynomial = CRC64::Ecma182);
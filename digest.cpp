@@ -4,44 +4,493 @@
 // see http://create.stephan-brumme.com/disclaimer.html
 //
 
-// g++ -O3 digest.cpp crc32.cpp md5.cpp sha1.cpp sha256.cpp keccak.cpp sha3.cpp -o digest
+// g++ -O3 digest.cpp crc32.cpp crc32c.cpp crc64.cpp md5.cpp sha1.cpp sha256.cpp sha512.cpp sha512_impl_generic.cpp keccak.cpp sha3.cpp keccakp.cpp sha256tree.cpp blake3.cpp threadpool.cpp multihash.cpp asyncreader.cpp -pthread -o digest
 
 #include "crc32.h"
+#include "crc32c.h"
+#include "crc64.h"
 #include "md5.h"
 #include "sha1.h"
 #include "sha256.h"
+#include "sha512.h"
 #include "keccak.h"
 #include "sha3.h"
+#include "sha256tree.h"
+#include "blake3.h"
+#include "threadpool.h"
+#include "multihash.h"
+#ifndef _MSC_VER
+#include "asyncreader.h"
+#endif
 
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <map>
+#include <cstdio>
 
-int main(int argc, char** argv)
+
+/// one producer, several consumers: each consumer sees all chunks in order and runs on its own thread
+/** A ring of chunks, each chunk is released when all consumers processed it (reference counting).
+    The slowest consumer determines the total time instead of the sum of all consumers. */
+class Broadcast
 {
-  // syntax check
-  if (argc < 2 || argc > 3)
+public:
+  /// process a chunk of data
+  typedef std::function<void(const char* data, size_t numBytes)> Consumer;
+
+  /// start one thread per consumer, push() splits data into chunks of at most chunkSize bytes
+  Broadcast(const std::vector<Consumer>& consumers, size_t chunkSize, size_t numChunks = 8)
+  : m_consumers(consumers),
+    m_chunks(numChunks),
+    m_chunkSize(chunkSize),
+    m_numPushed(0),
+    m_numReleased(0),
+    m_finished(false)
   {
-    std::cout << "./digest filename [--crc|--md5|--sha1|--sha256|--keccak|--sha3]" << std::endl;
-    return 1;
+    for (size_t i = 0; i < m_chunks.size(); i++)
+    {
+      m_chunks[i].storage.resize(chunkSize);
+      m_chunks[i].references = 0;
+    }
+    for (size_t i = 0; i < m_consumers.size(); i++)
+      m_threads.push_back(std::thread(&Broadcast::consumerLoop, this, i));
+  }
+
+  /// process all remaining chunks, then stop threads
+  ~Broadcast()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished = true;
+    }
+    m_signal.notify_all();
+
+    for (size_t i = 0; i < m_threads.size(); i++)
+      m_threads[i].join();
+  }
+
+  /// hand data to all consumers, it's copied unless it stays valid until wait() returns
+  void push(const char* data, size_t numBytes, bool copy = true)
+  {
+    while (numBytes > 0)
+    {
+      size_t numChunk = numBytes < m_chunkSize ? numBytes : m_chunkSize;
+
+      // oldest chunk must be released by all consumers
+      std::unique_lock<std::mutex> lock(m_mutex);
+      Chunk& chunk = m_chunks[m_numPushed % m_chunks.size()];
+      while (chunk.references > 0)
+        m_signal.wait(lock);
+      lock.unlock();
+
+      // no consumer accesses this chunk right now
+      if (copy)
+      {
+        memcpy(&chunk.storage[0], data, numChunk);
+        chunk.data = &chunk.storage[0];
+      }
+      else
+        chunk.data = data;
+      chunk.numBytes = numChunk;
+
+      lock.lock();
+      chunk.references = m_consumers.size();
+      m_numPushed++;
+      lock.unlock();
+      m_signal.notify_all();
+
+      data     += numChunk;
+      numBytes -= numChunk;
+    }
+  }
+
+  /// block until all consumers processed all pushed data
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_numReleased < m_numPushed)
+      m_signal.wait(lock);
+  }
+
+private:
+  /// a part of the input
+  struct Chunk
+  {
+    /// points to storage or external data
+    const char*       data;
+    size_t            numBytes;
+    /// number of consumers which didn't process this chunk yet
+    size_t            references;
+    /// copy of the input
+    std::vector<char> storage;
+  };
+
+  /// process all chunks in order
+  void consumerLoop(size_t id)
+  {
+    for (uint64_t next = 0; ; next++)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (next == m_numPushed && !m_finished)
+        m_signal.wait(lock);
+      if (next == m_numPushed)
+        return;
+      lock.unlock();
+
+      Chunk& chunk = m_chunks[next % m_chunks.size()];
+      m_consumers[id](chunk.data, chunk.numBytes);
+
+      // last consumer releases the chunk
+      lock.lock();
+      if (--chunk.references == 0)
+      {
+        m_numReleased++;
+        lock.unlock();
+        m_signal.notify_all();
+      }
+    }
+  }
+
+  /// all consumers
+  std::vector<Consumer>    m_consumers;
+  /// one thread per consumer
+  std::vector<std::thread> m_threads;
+  /// ring buffer
+  std::vector<Chunk>       m_chunks;
+  /// maximum size of a chunk
+  size_t                   m_chunkSize;
+
+  /// protects all following members and chunks' reference counters
+  std::mutex               m_mutex;
+  /// wakes up consumers (new chunk) and producer (released chunk)
+  std::condition_variable  m_signal;
+  /// number of chunks pushed so far
+  uint64_t                 m_numPushed;
+  /// number of chunks processed by all consumers
+  uint64_t                 m_numReleased;
+  /// true if destructor was called
+  bool                     m_finished;
+};
+
+// low-level file access: memory-mapped files, detect holes in sparse files
+#ifndef _MSC_VER
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+/// true if most pages of a memory-mapped file are in the page cache
+static bool isCached(const void* view, size_t numBytes)
+{
+  const size_t PageSize  = size_t(sysconf(_SC_PAGESIZE));
+  const size_t StepPages = 65536;
+  static thread_local unsigned char resident[StepPages];
+
+  size_t numPages = (numBytes + PageSize - 1) / PageSize;
+  size_t numCached = 0;
+  for (size_t page = 0; page < numPages; page += StepPages)
+  {
+    size_t numStep = numPages - page < StepPages ? numPages - page : StepPages;
+    if (mincore((char*) view + page * PageSize, numStep * PageSize, resident) != 0)
+      return true;
+    for (size_t i = 0; i < numStep; i++)
+      numCached += resident[i] & 1;
+  }
+
+  // at least 7/8 of all pages
+  return numCached >= numPages - numPages / 8;
+}
+#endif
+
+// each cycle processes about 1 MByte (divisible by 144 => improves Keccak/SHA3 performance)
+static const size_t BufferSize = 144*7*1024;
+// CRCs of large files are split into parts which are hashed in parallel
+static const uint64_t PartSize = 16*1024*1024;
+
+
+/// command-line parameters
+struct Options
+{
+  /// bypass page cache
+  bool   direct;
+  /// selected algorithms
+  bool   computeCrc32, computeCrc32c, computeCrc64, computeMd5, computeSha1, computeSha2,
+         computeSha384, computeSha512, computeSha512_256, computeKeccak, computeSha3, computeTree, computeBlake3;
+  /// only for SHA256 Merkle tree
+  size_t leafSize;
+
+  /// parse algorithm, empty means CRC32, MD5, SHA1, SHA256, Keccak and SHA3
+  Options(const std::string& algorithm, bool direct_)
+  : direct(direct_)
+  {
+    computeCrc32     = algorithm.empty() || algorithm == "--crc";
+    computeMd5       = algorithm.empty() || algorithm == "--md5";
+    computeSha1      = algorithm.empty() || algorithm == "--sha1";
+    computeSha2      = algorithm.empty() || algorithm == "--sha2" || algorithm == "--sha256";
+    computeCrc32c    = algorithm == "--crc32c";
+    computeCrc64     = algorithm == "--crc64";
+    // SHA384, SHA512 and SHA512/256 must be explicitly selected
+    computeSha384    = algorithm == "--sha384";
+    computeSha512    = algorithm == "--sha512";
+    computeSha512_256= algorithm == "--sha512-256";
+    computeKeccak    = algorithm.empty() || algorithm == "--keccak";
+    computeSha3      = algorithm.empty() || algorithm == "--sha3";
+    // SHA256 Merkle tree must be explicitly selected, optionally with a custom leaf size: --tree=1048576
+    computeTree      = algorithm == "--tree" || algorithm.compare(0, 7, "--tree=") == 0;
+    computeBlake3    = algorithm == "--blake3";
+    leafSize         = SHA256Tree::DefaultLeafSize;
+    if (algorithm.compare(0, 7, "--tree=") == 0)
+      leafSize = (size_t) strtoull(algorithm.c_str() + 7, NULL, 10);
+  }
+
+  /// true if parts of a file can be hashed independently and merged afterwards (CRC32 and CRC64 only)
+  bool isSplittable() const
+  {
+    return (computeCrc32 || computeCrc64) &&
+           !(computeCrc32c || computeMd5 || computeSha1 || computeSha2 || computeSha384 || computeSha512 ||
+             computeSha512_256 || computeKeccak || computeSha3 || computeTree || computeBlake3);
+  }
+
+  /// true if results of ranges hashed by different processes can be merged (CRC32, CRC64 and SHA256 tree only)
+  bool isMergeable() const
+  {
+    return (computeCrc32 || computeCrc64 || computeTree) &&
+           !(computeCrc32c || computeMd5 || computeSha1 || computeSha2 || computeSha384 || computeSha512 ||
+             computeSha512_256 || computeKeccak || computeSha3 || computeBlake3);
+  }
+};
+
+
+/// all hashes of a single input
+struct Digests
+{
+  CRC32  crc32;
+  CRC32C crc32c;
+  CRC64  crc64;
+  MD5    md5;
+  SHA1   sha1;
+  SHA256 sha2;
+  SHA384 sha384;
+  SHA512 sha512;
+  SHA512_256 sha512_256;
+  Keccak keccak;
+  SHA3   sha3;
+  /// only if selected: its buffer holds a few leaves per thread
+  std::unique_ptr<SHA256Tree> tree;
+  BLAKE3 blake3;
+
+  /// selected hashes
+  MultiHash multiHash;
+
+  explicit Digests(const Options& options)
+  : keccak(Keccak::Keccak256),
+    sha3  (SHA3  ::Bits256),
+    tree  (options.computeTree ? new SHA256Tree(options.leafSize) : NULL),
+    blake3(&ThreadPool::shared())
+  {
+    if (options.computeCrc32)
+      multiHash.attach(crc32);
+    if (options.computeCrc32c)
+      multiHash.attach(crc32c);
+    if (options.computeCrc64)
+      multiHash.attach(crc64);
+    if (options.computeMd5)
+      multiHash.attach(md5);
+    if (options.computeSha1)
+      multiHash.attach(sha1);
+    if (options.computeSha2)
+      multiHash.attach(sha2);
+    if (options.computeSha384)
+      multiHash.attach(sha384);
+    if (options.computeSha512)
+      multiHash.attach(sha512);
+    if (options.computeSha512_256)
+      multiHash.attach(sha512_256);
+    if (options.computeKeccak)
+      multiHash.attach(keccak);
+    if (options.computeSha3)
+      multiHash.attach(sha3);
+    if (options.computeTree)
+      multiHash.attach(*tree);
+    if (options.computeBlake3)
+      multiHash.attach(blake3);
+  }
+
+private:
+  /// no copies (multiHash points to members)
+  Digests(const Digests&);
+  Digests& operator=(const Digests&);
+};
+
+
+/// hash of an algorithm
+struct Result
+{
+  /// short name, e.g. for BSD-style "SHA256 (filename) = ..."
+  std::string tag;
+  /// long name for single-file output, e.g. "SHA2/256:   "
+  std::string label;
+  /// hex string
+  std::string hash;
+
+  Result(const std::string& tag_, const std::string& label_, const std::string& hash_)
+  : tag(tag_), label(label_), hash(hash_) {}
+};
+
+/// collect hashes of all selected algorithms
+static std::vector<Result> getResults(const Options& options, Digests& digests)
+{
+  std::vector<Result> results;
+  if (options.computeCrc32)
+    results.push_back(Result("CRC32",      "CRC32:      ", digests.crc32 .getHash()));
+  if (options.computeCrc32c)
+    results.push_back(Result("CRC32C",     "CRC32C:     ", digests.crc32c.getHash()));
+  if (options.computeCrc64)
+    results.push_back(Result("CRC64",      "CRC64:      ", digests.crc64 .getHash()));
+  if (options.computeMd5)
+    results.push_back(Result("MD5",        "MD5:        ", digests.md5   .getHash()));
+  if (options.computeSha1)
+    results.push_back(Result("SHA1",       "SHA1:       ", digests.sha1  .getHash()));
+  if (options.computeSha2)
+    results.push_back(Result("SHA256",     "SHA2/256:   ", digests.sha2  .getHash()));
+  if (options.computeSha384)
+    results.push_back(Result("SHA384",     "SHA2/384:   ", digests.sha384.getHash()));
+  if (options.computeSha512)
+    results.push_back(Result("SHA512",     "SHA2/512:   ", digests.sha512.getHash()));
+  if (options.computeSha512_256)
+    results.push_back(Result("SHA512-256", "SHA2/512-256: ", digests.sha512_256.getHash()));
+  if (options.computeKeccak)
+    results.push_back(Result("KECCAK-256", "Keccak/256: ", digests.keccak.getHash()));
+  if (options.computeSha3)
+    results.push_back(Result("SHA3-256",   "SHA3/256:   ", digests.sha3  .getHash()));
+  if (options.computeTree)
+    results.push_back(Result("SHA256-TREE", "SHA2/256 tree (" + std::to_string(digests.tree->getLeafSize()) + " bytes/leaf): ",
+                             digests.tree->getHash()));
+  if (options.computeBlake3)
+    results.push_back(Result("BLAKE3",     "BLAKE3:     ", digests.blake3.getHash()));
+  return results;
+}
+
+
+/// "hash  filename" (same as sha256sum etc.) for a single algorithm, else BSD-style "SHA256 (filename) = hash"
+static std::string formatResults(const std::vector<Result>& results, const std::string& filename)
+{
+  std::string output;
+  for (size_t i = 0; i < results.size(); i++)
+    if (results.size() == 1)
+      output += results[i].hash + "  " + filename + "\n";
+    else
+      output += results[i].tag + " (" + filename + ") = " + results[i].hash + "\n";
+  return output;
+}
+
+
+#ifndef _MSC_VER
+/// CRC32 / CRC64 of numBytes starting at offset: split into parts which are hashed in parallel and merged afterwards
+static bool hashParts(int handle, uint64_t offset, uint64_t numBytes, const Options& options, Digests& digests)
+{
+  size_t numParts = size_t((numBytes + PartSize - 1) / PartSize);
+  std::vector<CRC32> crc32(numParts);
+  std::vector<CRC64> crc64(numParts);
+  std::atomic<bool>  failed(false);
+
+  ThreadPool::shared().run(numParts, [&](size_t part)
+  {
+    static thread_local std::vector<char> buffer(BufferSize);
+    uint64_t position = offset + part * PartSize;
+    uint64_t last     = std::min(position + PartSize, offset + numBytes);
+    while (position < last && !failed)
+    {
+      size_t  numChunk     = size_t(std::min(last - position, uint64_t(BufferSize)));
+      ssize_t numBytesRead = pread(handle, &buffer[0], numChunk, off_t(position));
+      if (numBytesRead <= 0)
+      {
+        failed = true;
+        break;
+      }
+      if (options.computeCrc32)
+        crc32[part].add(&buffer[0], size_t(numBytesRead));
+      if (options.computeCrc64)
+        crc64[part].add(&buffer[0], size_t(numBytesRead));
+      position += numBytesRead;
+    }
+  });
+  if (failed)
+    return false;
+
+  for (size_t part = 0; part < numParts; part++)
+  {
+    digests.crc32.combine(crc32[part]);
+    digests.crc64.combine(crc64[part]);
+  }
+  return true;
+}
+#endif
+
+
+/// hash a file or standard-in ("-"), useThreads = true: several hashes may run on their own threads
+static bool hashFile(const std::string& filename, const Options& options, Digests& digests, bool useThreads,
+                     std::string& error)
+{
+  // one buffer per thread, re-used for all files
+  static thread_local std::vector<char> storage(BufferSize);
+  char* buffer = &storage[0];
+
+  // several hashes and several cores ? then each hash runs on its own thread
+  MultiHash& multiHash = digests.multiHash;
+  std::unique_ptr<Broadcast> broadcast;
+  if (useThreads && multiHash.getNumHashes() > 1 && std::thread::hardware_concurrency() > 1)
+  {
+    std::vector<Broadcast::Consumer> consumers;
+    for (size_t i = 0; i < multiHash.getNumHashes(); i++)
+      consumers.push_back([&multiHash, i](const char* data, size_t numBytes) { multiHash.addSingle(i, data, numBytes); });
+    broadcast.reset(new Broadcast(consumers, BufferSize));
   }
 
-  // parameters
-  std::string filename  = argv[1];
-  std::string algorithm = argc == 3 ? argv[2] : "";
-  bool computeCrc32     = algorithm.empty() || algorithm == "--crc";
-  bool computeMd5       = algorithm.empty() || algorithm == "--md5";
-  bool computeSha1      = algorithm.empty() || algorithm == "--sha1";
-  bool computeSha2      = algorithm.empty() || algorithm == "--sha2" || algorithm == "--sha256";
-  bool computeKeccak    = algorithm.empty() || algorithm == "--keccak";
-  bool computeSha3      = algorithm.empty() || algorithm == "--sha3";
+  // feed all selected hashes
+  auto process = [&](const char* data, size_t numBytesRead)
+  {
+    if (broadcast)
+    {
+      broadcast->push(data, numBytesRead);
+      return;
+    }
+
+    // single core: all hashes process the same L1-sized tile before moving on to the next tile
+    multiHash.add(data, numBytesRead);
+  };
+
+  // a hole of a sparse file: CRC32 skips it in O(log n), all other hashes still have to process each zero
+  auto processZeros = [&](uint64_t numBytes)
+  {
+    if (options.computeCrc32 && multiHash.getNumHashes() == 1)
+    {
+      digests.crc32.addZeros(numBytes);
+      return;
+    }
 
-  CRC32  digestCrc32;
-  MD5    digestMd5;
-  SHA1   digestSha1;
-  SHA256 digestSha2;
-  Keccak digestKeccak(Keccak::Keccak256);
-  SHA3   digestSha3  (SHA3  ::Bits256);
+    memset(buffer, 0, BufferSize);
+    while (numBytes > 0)
+    {
+      size_t numZeros = numBytes < BufferSize ? size_t(numBytes) : BufferSize;
+      process(buffer, numZeros);
+      numBytes -= numZeros;
+    }
+  };
 
+#ifdef _MSC_VER
   // select input source: either file or standard-in
   std::ifstream file;
   std::istream* input = NULL;
@@ -56,54 +505,1341 @@ int main(int argc, char** argv)
     file.open(filename.c_str(), std::ios::in | std::ios::binary);
     if (!file)
     {
-      std::cerr << "Can't open '" << filename << "'" << std::endl;
-      return 2;
+      error = "Can't open '" + filename + "'";
+      return false;
     }
 
     input = &file;
   }
 
-  // each cycle processes about 1 MByte (divisible by 144 => improves Keccak/SHA3 performance)
-  const size_t BufferSize = 144*7*1024;
-  char* buffer = new char[BufferSize];
-
   // process file
   while (*input)
   {
     input->read(buffer, BufferSize);
     std::size_t numBytesRead = size_t(input->gcount());
+    process(buffer, numBytesRead);
+  }
 
-    if (computeCrc32)
-      digestCrc32 .add(buffer, numBytesRead);
-    if (computeMd5)
-      digestMd5   .add(buffer, numBytesRead);
-    if (computeSha1)
-      digestSha1  .add(buffer, numBytesRead);
-    if (computeSha2)
-      digestSha2  .add(buffer, numBytesRead);
-    if (computeKeccak)
-      digestKeccak.add(buffer, numBytesRead);
-    if (computeSha3)
-      digestSha3  .add(buffer, numBytesRead);
-  }
-
-  // clean up
   file.close();
-  delete[] buffer;
-
-  // show results
-  if (computeCrc32)
-    std::cout << "CRC32:      " << digestCrc32 .getHash() << std::endl;
-  if (computeMd5)
-    std::cout << "MD5:        " << digestMd5   .getHash() << std::endl;
-  if (computeSha1)
-    std::cout << "SHA1:       " << digestSha1  .getHash() << std::endl;
-  if (computeSha2)
-    std::cout << "SHA2/256:   " << digestSha2  .getHash() << std::endl;
-  if (computeKeccak)
-    std::cout << "Keccak/256: " << digestKeccak.getHash() << std::endl;
-  if (computeSha3)
-    std::cout << "SHA3/256:   " << digestSha3  .getHash() << std::endl;
-
-  return 0;
+#else
+  // select input source: either file or standard-in, syntax will be: "./digest - --sha3 < data"
+  int handle = filename == "-" ? STDIN_FILENO : open(filename.c_str(), O_RDONLY);
+  if (handle < 0)
+  {
+    error = "Can't open '" + filename + "'";
+    return false;
+  }
+
+  // only regular files can be memory-mapped or have holes, a single fstat per file
+  struct stat info;
+  bool statOk   = fstat(handle, &info) == 0;
+  bool regular  = statOk && S_ISREG(info.st_mode) && info.st_size > 0;
+  bool finished = false;
+
+  // bypass page cache: O_DIRECT needs aligned buffers, offsets and sizes (AsyncReader's defaults are fine),
+  // not supported by all file systems (e.g. tmpfs) => drop pages right behind the read cursor instead
+  bool dropCache = false;
+  if (options.direct && statOk && (S_ISREG(info.st_mode) || S_ISBLK(info.st_mode)))
+  {
+    dropCache = true;
+#ifdef O_DIRECT
+    int flags = fcntl(handle, F_GETFL);
+    if (flags >= 0 && lseek(handle, 0, SEEK_CUR) % 4096 == 0 && fcntl(handle, F_SETFL, flags | O_DIRECT) == 0)
+      dropCache = false;
+#endif
+  }
+  // remove pages from page cache (if --direct without O_DIRECT)
+  auto evict = [&](off_t from, off_t numBytes)
+  {
+#ifdef POSIX_FADV_DONTNEED
+    if (dropCache)
+      posix_fadvise(handle, from, numBytes, POSIX_FADV_DONTNEED);
+#endif
+  };
+
+  // small file: a plain read() is cheaper than memory mapping or setting up io_uring (matters for millions of files)
+  if (!finished && !options.direct && regular && uint64_t(info.st_size) <= BufferSize)
+  {
+    ssize_t numBytesRead;
+    while ((numBytesRead = read(handle, buffer, BufferSize)) != 0)
+    {
+      if (numBytesRead < 0 && errno == EINTR)
+        continue;
+      if (numBytesRead < 0)
+      {
+        error = "Can't read '" + filename + "'";
+        close(handle);
+        return false;
+      }
+      process(buffer, size_t(numBytesRead));
+    }
+    finished = true;
+  }
+
+  // sparse file ? then don't read its holes from disk (only if the file system can locate them)
+#ifdef SEEK_HOLE
+  off_t fileSize  = regular ? info.st_size : -1;
+  // SEEK_HOLE returns the file size if there are no holes
+  off_t start     = regular && !finished ? lseek(handle, 0, SEEK_CUR) : -1;
+  off_t firstHole = start >= 0 ? lseek(handle, start, SEEK_HOLE) : -1;
+  // lseek moved the file position, AsyncReader starts reading at the current file position
+  if (start >= 0)
+    lseek(handle, start, SEEK_SET);
+  if (firstHole >= 0 && firstHole < fileSize)
+  {
+    finished = true;
+#ifdef O_DIRECT
+    // buffer isn't aligned, data extents are read through the page cache and evicted
+    if (options.direct && !dropCache && fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) & ~O_DIRECT) == 0)
+      dropCache = true;
+#endif
+    // skip whatever was already consumed from the file (e.g. partially read standard-in)
+    off_t position = start;
+    bool  failed   = false;
+    while (position < fileSize && !failed)
+    {
+      // fails with ENXIO if there's no more data behind position
+      off_t dataStart = lseek(handle, position, SEEK_DATA);
+      if (dataStart < 0 && errno == ENXIO)
+        dataStart = fileSize;
+      off_t dataEnd   = dataStart >= 0 && dataStart < fileSize ? lseek(handle, dataStart, SEEK_HOLE) : fileSize;
+      if (dataStart < 0 || dataEnd < 0)
+      {
+        failed = true;
+        break;
+      }
+      if (dataStart > fileSize)
+        dataStart = fileSize;
+      if (dataEnd > fileSize)
+        dataEnd = fileSize;
+
+      processZeros(uint64_t(dataStart - position));
+
+      // read data until next hole
+      position = dataStart;
+      while (position < dataEnd)
+      {
+        size_t  numBytes     = dataEnd - position < off_t(BufferSize) ? size_t(dataEnd - position) : BufferSize;
+        ssize_t numBytesRead = pread(handle, buffer, numBytes, position);
+        if (numBytesRead < 0 && errno == EINTR)
+          continue;
+        // read error or file truncated while reading
+        if (numBytesRead <= 0)
+        {
+          failed = true;
+          break;
+        }
+        process(buffer, size_t(numBytesRead));
+        evict(position, numBytesRead);
+        position += numBytesRead;
+      }
+    }
+    evict(0, 0);
+
+    if (failed)
+    {
+      error = "Can't read '" + filename + "'";
+      close(handle);
+      return false;
+    }
+  }
+#endif
+
+  // large file and only CRC32 / CRC64: hash parts on all CPU cores
+  if (!finished && !options.direct && regular && options.isSplittable() &&
+      uint64_t(info.st_size) >= 4 * PartSize && ThreadPool::shared().getNumThreads() > 1)
+  {
+    off_t position = lseek(handle, 0, SEEK_CUR);
+    if (position < 0 || !hashParts(handle, uint64_t(position), uint64_t(info.st_size - position), options, digests))
+    {
+      error = "Can't read '" + filename + "'";
+      close(handle);
+      return false;
+    }
+    finished = true;
+  }
+
+  // regular file: hash the page cache directly instead of copying it to buffer first
+  off_t current = !finished && !options.direct && regular ? lseek(handle, 0, SEEK_CUR) : -1;
+  if (current >= 0 && current <= info.st_size && off_t(size_t(info.st_size)) == info.st_size)
+  {
+    // start at the current file position (e.g. standard-in was partially read), mmap needs a page-aligned offset
+    off_t  first    = current - current % off_t(sysconf(_SC_PAGESIZE));
+    size_t skip     = size_t(current - first);
+    size_t numBytes = size_t(info.st_size - first);
+    void*  view     = numBytes > 0 ? mmap(NULL, numBytes, PROT_READ, MAP_SHARED, handle, first) : MAP_FAILED;
+    // mostly cached ? else page faults would stall the hashes, so let AsyncReader keep the disk busy instead
+    if (view != MAP_FAILED && !isCached(view, numBytes))
+    {
+      munmap(view, numBytes);
+      view = MAP_FAILED;
+    }
+    if (view != MAP_FAILED)
+    {
+      // aggressive read-ahead, huge pages are only available for some file systems (errors are irrelevant)
+      madvise(view, numBytes, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+      madvise(view, numBytes, MADV_HUGEPAGE);
+#endif
+      // same chunk size as AsyncReader: all selected hashes see the same data while it's still in the CPU cache
+      const char* data = (const char*) view;
+      for (size_t offset = skip; offset < numBytes; offset += BufferSize)
+      {
+        size_t numChunk = numBytes - offset < BufferSize ? numBytes - offset : BufferSize;
+        // no need to copy, the file stays mapped until all threads are done
+        if (broadcast)
+          broadcast->push(data + offset, numChunk, false);
+        else
+          process(data + offset, numChunk);
+      }
+
+      if (broadcast)
+        broadcast->wait();
+      munmap(view, numBytes);
+      finished = true;
+    }
+  }
+
+  // uncached files, pipes, devices, ...: hash a buffer while the next ones are read
+  if (!finished)
+  {
+    // --direct: a deeper queue of larger requests, the page cache doesn't read ahead anymore
+    AsyncReader reader(handle, options.direct ? 4 * BufferSize : BufferSize,
+                               options.direct ? 8 : AsyncReader::DefaultNumBuffers);
+    off_t first    = dropCache ? lseek(handle, 0, SEEK_CUR) : 0;
+    off_t position = first;
+    const void* data;
+    ptrdiff_t   numBytesRead;
+    while ((numBytesRead = reader.next(data)) > 0)
+    {
+      process((const char*) data, size_t(numBytesRead));
+      evict(position, numBytesRead);
+      position += numBytesRead;
+    }
+    // pages which were still locked by read-ahead (zero means "until the end of file")
+    evict(first, 0);
+
+    if (numBytesRead < 0)
+    {
+      error = "Can't read '" + filename + "'";
+      close(handle);
+      return false;
+    }
+  }
+
+  if (handle != STDIN_FILENO)
+    close(handle);
+#endif
+
+  return true;
+}
+
+
+/// copy standard-in to standard-out and hash it on the fly (pipe filter)
+static bool teeStream(Digests& digests, std::string& error)
+{
+  static std::vector<char> storage(BufferSize);
+  char* buffer = &storage[0];
+
+#ifdef _MSC_VER
+  while (std::cin)
+  {
+    std::cin.read(buffer, BufferSize);
+    std::size_t numBytesRead = size_t(std::cin.gcount());
+    digests.multiHash.add(buffer, numBytesRead);
+    std::cout.write(buffer, numBytesRead);
+  }
+  std::cout.flush();
+  if (!std::cout)
+  {
+    error = "Can't write to standard-out";
+    return false;
+  }
+#else
+  // write a whole buffer, standard-out may accept only a part of it
+  auto writeAll = [&](const char* data, size_t numBytes)
+  {
+    while (numBytes > 0)
+    {
+      ssize_t numWritten = write(STDOUT_FILENO, data, numBytes);
+      if (numWritten < 0 && errno == EINTR)
+        continue;
+      if (numWritten <= 0)
+        return false;
+      data     += numWritten;
+      numBytes -= size_t(numWritten);
+    }
+    return true;
+  };
+
+  // both are pipes ? then tee() duplicates the data in the kernel without copying it to standard-out,
+  // only the hashes need a copy in user space (which also removes the duplicated data from standard-in)
+  bool useTee = true;
+  while (true)
+  {
+    ssize_t numBytes = -1;
+#ifdef SPLICE_F_MORE
+    if (useTee)
+    {
+      numBytes = tee(STDIN_FILENO, STDOUT_FILENO, BufferSize, 0);
+      if (numBytes < 0 && errno == EINTR)
+        continue;
+      // EINVAL: not a pipe
+      if (numBytes < 0 && errno == EINVAL)
+        useTee = false;
+      else if (numBytes < 0)
+      {
+        error = "Can't write to standard-out";
+        return false;
+      }
+    }
+#else
+    useTee = false;
+#endif
+    // plain read() and write()
+    if (!useTee)
+    {
+      numBytes = read(STDIN_FILENO, buffer, BufferSize);
+      if (numBytes < 0 && errno == EINTR)
+        continue;
+      if (numBytes < 0)
+      {
+        error = "Can't read standard-in";
+        return false;
+      }
+      if (!writeAll(buffer, size_t(numBytes)))
+      {
+        error = "Can't write to standard-out";
+        return false;
+      }
+      digests.multiHash.add(buffer, size_t(numBytes));
+    }
+    else
+    {
+      // consume exactly the data which was already passed on
+      size_t numRead = 0;
+      while (numRead < size_t(numBytes))
+      {
+        ssize_t numBytesRead = read(STDIN_FILENO, buffer + numRead, size_t(numBytes) - numRead);
+        if (numBytesRead < 0 && errno == EINTR)
+          continue;
+        if (numBytesRead <= 0)
+        {
+          error = "Can't read standard-in";
+          return false;
+        }
+        numRead += size_t(numBytesRead);
+      }
+      digests.multiHash.add(buffer, numRead);
+    }
+
+    if (numBytes == 0)
+      break;
+  }
+#endif
+
+  return true;
+}
+
+
+#ifndef _MSC_VER
+/// hash numBytes starting at offset (less if the file is shorter), numBytes returns the number of hashed bytes,
+/// fileSize the size of the whole file (~0 if unknown, e.g. pipes)
+static bool hashRange(const std::string& filename, uint64_t offset, uint64_t& numBytes, uint64_t& fileSize,
+                      const Options& options, Digests& digests, std::string& error)
+{
+  int handle = filename == "-" ? STDIN_FILENO : open(filename.c_str(), O_RDONLY);
+  if (handle < 0)
+  {
+    error = "Can't open '" + filename + "'";
+    return false;
+  }
+
+  // don't read beyond the end of a regular file
+  struct stat info;
+  uint64_t end = ~uint64_t(0);
+  if (fstat(handle, &info) == 0 && S_ISREG(info.st_mode))
+    end = uint64_t(info.st_size);
+  if (offset > end)
+    offset = end;
+  if (numBytes > end - offset)
+    numBytes = end - offset;
+  fileSize = end;
+
+  bool ok = true;
+  // large range and only CRC32 / CRC64: hash parts on all CPU cores
+  if (options.isSplittable() && numBytes >= 4 * PartSize && end != ~uint64_t(0) && ThreadPool::shared().getNumThreads() > 1)
+    ok = hashParts(handle, offset, numBytes, options, digests);
+  else
+  {
+    static thread_local std::vector<char> storage(BufferSize);
+    // pipes can't seek: skip the first bytes
+    bool seekable = lseek(handle, 0, SEEK_CUR) >= 0;
+    for (uint64_t skipped = 0; !seekable && skipped < offset; )
+    {
+      ssize_t numBytesRead = read(handle, &storage[0], size_t(std::min(offset - skipped, uint64_t(BufferSize))));
+      if (numBytesRead < 0 && errno == EINTR)
+        continue;
+      if (numBytesRead <= 0)
+      {
+        ok = numBytesRead == 0;
+        numBytes = 0;
+        break;
+      }
+      skipped += uint64_t(numBytesRead);
+    }
+
+    uint64_t position = offset;
+    while (ok && position - offset < numBytes)
+    {
+      size_t  numChunk     = size_t(std::min(numBytes - (position - offset), uint64_t(BufferSize)));
+      ssize_t numBytesRead = seekable ? pread(handle, &storage[0], numChunk, off_t(position))
+                                      : read (handle, &storage[0], numChunk);
+      if (numBytesRead < 0 && errno == EINTR)
+        continue;
+      // end of device
+      if (numBytesRead == 0)
+        break;
+      if (numBytesRead < 0)
+      {
+        ok = false;
+        break;
+      }
+      digests.multiHash.add(&storage[0], size_t(numBytesRead));
+      position += uint64_t(numBytesRead);
+    }
+    numBytes = position - offset;
+  }
+
+  if (handle != STDIN_FILENO)
+    close(handle);
+  if (!ok)
+    error = "Can't read '" + filename + "'";
+  return ok;
+}
+#endif
+
+
+#ifndef _MSC_VER
+/// append all files below a directory, sorted by name (symbolic links to directories aren't followed)
+static bool listDirectory(const std::string& path, std::vector<std::string>& files)
+{
+  DIR* dir = opendir(path.c_str());
+  if (!dir)
+  {
+    std::cerr << "Can't open '" << path << "'" << std::endl;
+    return false;
+  }
+
+  // the file type is part of the directory entry, no need to stat each file (except for symbolic links)
+  std::string prefix = path[path.size() - 1] == '/' ? path : path + "/";
+  std::vector<std::pair<std::string, bool> > entries; // name and "is a directory"
+  while (struct dirent* entry = readdir(dir))
+  {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+
+    unsigned char type = entry->d_type;
+    if (type == DT_LNK || type == DT_UNKNOWN)
+    {
+      struct stat info;
+      // follow links to files, but not to directories
+      if (stat((prefix + name).c_str(), &info) != 0)
+        continue;
+      if (S_ISREG(info.st_mode))
+        type = DT_REG;
+      else if (S_ISDIR(info.st_mode) && type == DT_UNKNOWN)
+        type = DT_DIR;
+    }
+
+    if (type == DT_REG || type == DT_DIR)
+      entries.push_back(std::make_pair(name, type == DT_DIR));
+  }
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end());
+
+  bool ok = true;
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].second)
+      ok &= listDirectory(prefix + entries[i].first, files);
+    else
+      files.push_back(prefix + entries[i].first);
+  return ok;
+}
+#endif
+
+
+/// true if path is a directory
+static bool isDirectory(const std::string& path)
+{
+#ifdef _MSC_VER
+  return false;
+#else
+  struct stat info;
+  return path != "-" && stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+
+/// run task(0), task(1), ... on all CPU cores but print their output in order, returns number of failed tasks
+/** A task fills output (stdout) and/or error (stderr), a non-empty error means "failed". */
+static size_t runOrdered(size_t numTasks, const std::function<void(size_t, std::string&, std::string&)>& task)
+{
+  // tasks are processed in windows: all tasks of a window are processed in parallel, then printed in order
+  const size_t WindowSize = 4096;
+  // each worker processes a few tasks at once, work stealing balances small and large files
+  const size_t BatchSize  = 8;
+
+  size_t numFailed = 0;
+  for (size_t first = 0; first < numTasks; first += WindowSize)
+  {
+    size_t numWindow  = std::min(WindowSize, numTasks - first);
+    size_t numBatches = (numWindow + BatchSize - 1) / BatchSize;
+    std::vector<std::string> output(numWindow);
+    std::vector<std::string> errors(numWindow);
+
+    ThreadPool::shared().run(numBatches, [&](size_t batch)
+    {
+      for (size_t i = batch * BatchSize; i < std::min((batch + 1) * BatchSize, numWindow); i++)
+        task(first + i, output[i], errors[i]);
+    });
+
+    for (size_t i = 0; i < numWindow; i++)
+    {
+      std::cout << output[i];
+      if (errors[i].empty())
+        continue;
+
+      std::cout << std::flush;
+      std::cerr << errors[i] << std::endl;
+      numFailed++;
+    }
+  }
+  return numFailed;
+}
+
+
+/// name, command-line option and size of each algorithm
+struct Algorithm
+{
+  const char* tag;
+  const char* option;
+  size_t      hashBytes;
+};
+/// ordered by hash size: the first match is the most common algorithm with that size (used when guessing)
+static const Algorithm Algorithms[] =
+{
+  { "CRC32",       "--crc",        CRC32     ::HashBytes },
+  { "CRC32C",      "--crc32c",     CRC32C    ::HashBytes },
+  { "CRC64",       "--crc64",      CRC64     ::HashBytes },
+  { "MD5",         "--md5",        MD5       ::HashBytes },
+  { "SHA1",        "--sha1",       SHA1      ::HashBytes },
+  { "SHA256",      "--sha256",     SHA256    ::HashBytes },
+  { "SHA384",      "--sha384",     SHA384    ::HashBytes },
+  { "SHA512",      "--sha512",     SHA512    ::HashBytes },
+  { "SHA512-256",  "--sha512-256", SHA512_256::HashBytes },
+  { "KECCAK-256",  "--keccak",     256 / 8               },
+  { "SHA3-256",    "--sha3",       256 / 8               },
+  { "SHA256-TREE", "--tree",       SHA256Tree::HashBytes },
+  { "BLAKE3",      "--blake3",     BLAKE3    ::HashBytes }
+};
+static const size_t NumAlgorithms = sizeof(Algorithms) / sizeof(Algorithms[0]);
+
+/// find an algorithm by its command-line option, NULL if unknown
+static const Algorithm* findAlgorithm(const std::string& option)
+{
+  // aliases
+  if (option == "--sha2")
+    return findAlgorithm("--sha256");
+  if (option.compare(0, 7, "--tree=") == 0)
+    return findAlgorithm("--tree");
+
+  for (size_t i = 0; i < NumAlgorithms; i++)
+    if (option == Algorithms[i].option)
+      return &Algorithms[i];
+  return NULL;
+}
+
+
+/// raw hash of the selected algorithm (only one algorithm must be selected)
+static std::vector<unsigned char> getRawHash(const Options& options, Digests& digests)
+{
+  unsigned char buffer[64];
+  size_t numBytes = 0;
+  if (options.computeCrc32)      { digests.crc32     .getHash(buffer); numBytes = CRC32     ::HashBytes; }
+  if (options.computeCrc32c)     { digests.crc32c    .getHash(buffer); numBytes = CRC32C    ::HashBytes; }
+  if (options.computeCrc64)      { digests.crc64     .getHash(buffer); numBytes = CRC64     ::HashBytes; }
+  if (options.computeMd5)        { digests.md5       .getHash(buffer); numBytes = MD5       ::HashBytes; }
+  if (options.computeSha1)       { digests.sha1      .getHash(buffer); numBytes = SHA1      ::HashBytes; }
+  if (options.computeSha2)       { digests.sha2      .getHash(buffer); numBytes = SHA256    ::HashBytes; }
+  if (options.computeSha384)     { digests.sha384    .getHash(buffer); numBytes = SHA384    ::HashBytes; }
+  if (options.computeSha512)     { digests.sha512    .getHash(buffer); numBytes = SHA512    ::HashBytes; }
+  if (options.computeSha512_256) { digests.sha512_256.getHash(buffer); numBytes = SHA512_256::HashBytes; }
+  if (options.computeKeccak)     { digests.keccak    .getHash(buffer); numBytes = 256 / 8; }
+  if (options.computeSha3)       { digests.sha3      .getHash(buffer); numBytes = 256 / 8; }
+  if (options.computeTree)       { digests.tree     ->getHash(buffer); numBytes = SHA256Tree::HashBytes; }
+  if (options.computeBlake3)     { digests.blake3    .getHash(buffer); numBytes = BLAKE3    ::HashBytes; }
+  return std::vector<unsigned char>(buffer, buffer + numBytes);
+}
+
+
+/// convert hex string to bytes, false if not a valid hex string
+static bool hexToBytes(const std::string& hex, std::string& bytes)
+{
+  if (hex.size() % 2 != 0)
+    return false;
+
+  bytes.assign(hex.size() / 2, 0);
+  for (size_t i = 0; i < hex.size(); i++)
+  {
+    char c = hex[i];
+    int nibble;
+    if (c >= '0' && c <= '9')
+      nibble = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      nibble = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      nibble = c - 'A' + 10;
+    else
+      return false;
+
+    bytes[i / 2] |= char(i % 2 == 0 ? nibble << 4 : nibble);
+  }
+  return true;
+}
+
+/// convert bytes to lower-case hex string
+static std::string bytesToHex(const std::string& bytes)
+{
+  static const char dec2hex[16+1] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(2 * bytes.size());
+  for (size_t i = 0; i < bytes.size(); i++)
+  {
+    hex += dec2hex[(bytes[i] >> 4) & 15];
+    hex += dec2hex[ bytes[i]       & 15];
+  }
+  return hex;
+}
+
+
+/// a line of a checksum file
+struct CheckEntry
+{
+  /// file to be verified
+  std::string filename;
+  /// command-line option of its algorithm
+  std::string algorithm;
+  /// raw hash
+  std::vector<unsigned char> expected;
+};
+
+/// parse "<hex>  <filename>" (coreutils, "*" instead of the second space in binary mode) or "TAG (filename) = <hex>" (BSD),
+/// the algorithm is guessed from the hash size if the command-line doesn't specify one
+static bool parseCheckLine(std::string line, const std::string& algorithm, CheckEntry& entry)
+{
+  // coreutils escapes filenames which contain a backslash or a newline and prepends a backslash to the line
+  bool escaped = !line.empty() && line[0] == '\\';
+  if (escaped)
+    line.erase(0, 1);
+
+  std::string hex;
+  entry.algorithm.clear();
+
+  // BSD-style: tag must be known and match the command-line
+  size_t open  = line.find(" (");
+  size_t close = line.rfind(") = ");
+  if (open != std::string::npos && close != std::string::npos && open < close)
+  {
+    std::string tag = line.substr(0, open);
+    for (size_t i = 0; i < NumAlgorithms; i++)
+      if (tag == Algorithms[i].tag)
+      {
+        if (!algorithm.empty() && findAlgorithm(algorithm) != &Algorithms[i])
+          return false;
+        // keep a custom leaf size of --tree=...
+        entry.algorithm = algorithm.empty() ? Algorithms[i].option : algorithm;
+      }
+
+    entry.filename = line.substr(open + 2, close - open - 2);
+    hex            = line.substr(close + 4);
+  }
+
+  // coreutils
+  if (entry.algorithm.empty())
+  {
+    size_t space = line.find(' ');
+    if (space == std::string::npos || space + 2 >= line.size() || (line[space + 1] != ' ' && line[space + 1] != '*'))
+      return false;
+
+    hex             = line.substr(0, space);
+    entry.filename  = line.substr(space + 2);
+    entry.algorithm = algorithm;
+    for (size_t i = 0; i < NumAlgorithms && entry.algorithm.empty(); i++)
+      if (Algorithms[i].hashBytes * 2 == hex.size())
+        entry.algorithm = Algorithms[i].option;
+  }
+
+  if (escaped)
+  {
+    std::string unescaped;
+    for (size_t i = 0; i < entry.filename.size(); i++)
+    {
+      char c = entry.filename[i];
+      if (c == '\\' && i + 1 < entry.filename.size())
+      {
+        c = entry.filename[++i];
+        if (c == 'n')
+          c = '\n';
+        else if (c == 'r')
+          c = '\r';
+      }
+      unescaped += c;
+    }
+    entry.filename = unescaped;
+  }
+
+  // hash must match the algorithm's size
+  const Algorithm* found = findAlgorithm(entry.algorithm);
+  if (entry.filename.empty() || found == NULL || hex.size() != 2 * found->hashBytes)
+    return false;
+
+  // hex to binary
+  std::string bytes;
+  if (!hexToBytes(hex, bytes))
+    return false;
+  entry.expected.assign(bytes.begin(), bytes.end());
+  return true;
+}
+
+
+/// verify all files listed in a checksum file ("-" is standard-in), returns exit code
+static int checkFiles(const std::string& checksumFile, const std::string& algorithm, bool direct)
+{
+  std::ifstream file;
+  if (checksumFile != "-")
+  {
+    file.open(checksumFile.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+    {
+      std::cerr << "Can't open '" << checksumFile << "'" << std::endl;
+      return 2;
+    }
+  }
+  std::istream& input = checksumFile == "-" ? std::cin : file;
+
+  // parse all lines
+  std::vector<CheckEntry> entries;
+  size_t numInvalid = 0;
+  std::string line;
+  while (std::getline(input, line))
+  {
+    // Windows line endings, empty lines and comments
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    CheckEntry entry;
+    if (parseCheckLine(line, algorithm, entry))
+      entries.push_back(entry);
+    else
+      numInvalid++;
+  }
+
+  // compare binary hashes, not strings (case-insensitive hex)
+  size_t numMismatches = 0;
+  std::mutex mismatchLock;
+  size_t numUnreadable = runOrdered(entries.size(), [&](size_t i, std::string& output, std::string& error)
+  {
+    const CheckEntry& entry = entries[i];
+    // escape filenames the same way as coreutils
+    std::string name;
+    for (size_t j = 0; j < entry.filename.size(); j++)
+      switch (entry.filename[j])
+      {
+        case '\\': name += "\\\\"; break;
+        case '\n': name += "\\n";  break;
+        case '\r': name += "\\r";  break;
+        default:   name += entry.filename[j];
+      }
+    if (name.size() != entry.filename.size())
+      name = "\\" + name;
+
+    Options options(entry.algorithm, direct);
+    Digests digests(options);
+    if (!hashFile(entry.filename, options, digests, false, error))
+    {
+      output = name + ": FAILED open or read\n";
+      return;
+    }
+
+    bool ok = getRawHash(options, digests) == entry.expected;
+    output  = name + (ok ? ": OK\n" : ": FAILED\n");
+    if (!ok)
+    {
+      std::lock_guard<std::mutex> lock(mismatchLock);
+      numMismatches++;
+    }
+  });
+
+  // same warnings as coreutils
+  if (numInvalid > 0)
+    std::cerr << "WARNING: " << numInvalid    << (numInvalid    == 1 ? " line is"  : " lines are")  << " improperly formatted" << std::endl;
+  if (numUnreadable > 0)
+    std::cerr << "WARNING: " << numUnreadable << " listed " << (numUnreadable == 1 ? "file" : "files") << " could not be read" << std::endl;
+  if (numMismatches > 0)
+    std::cerr << "WARNING: " << numMismatches << " computed " << (numMismatches == 1 ? "checksum" : "checksums") << " did NOT match" << std::endl;
+  if (entries.empty())
+  {
+    std::cerr << "No properly formatted checksum lines found in '" << checksumFile << "'" << std::endl;
+    return 1;
+  }
+
+  return numMismatches > 0 || numUnreadable > 0 ? 1 : 0;
+}
+
+
+#ifndef _MSC_VER
+/// internal state of a selected hash, stored in checkpoints
+struct HashState
+{
+  const char* tag;
+  std::function<std::string()>                  get;
+  std::function<bool(const std::string& state)> set;
+};
+
+/// all selected hashes which can export their internal state, false if any selected hash can't
+static bool getHashStates(const Options& options, Digests& digests, std::vector<HashState>& states)
+{
+  if (options.computeCrc32c || options.computeCrc64 || options.computeSha384 || options.computeSha512 ||
+      options.computeSha512_256 || options.computeTree || options.computeBlake3)
+    return false;
+
+  // same order as getResults
+  if (options.computeCrc32)
+    states.push_back({ "CRC32",      [&] { return digests.crc32 .getState(); }, [&](const std::string& state) { return digests.crc32 .setState(state); } });
+  if (options.computeMd5)
+    states.push_back({ "MD5",        [&] { return digests.md5   .getState(); }, [&](const std::string& state) { return digests.md5   .setState(state); } });
+  if (options.computeSha1)
+    states.push_back({ "SHA1",       [&] { return digests.sha1  .getState(); }, [&](const std::string& state) { return digests.sha1  .setState(state); } });
+  if (options.computeSha2)
+    states.push_back({ "SHA256",     [&] { return digests.sha2  .getState(); }, [&](const std::string& state) { return digests.sha2  .setState(state); } });
+  if (options.computeKeccak)
+    states.push_back({ "KECCAK-256", [&] { return digests.keccak.getState(); }, [&](const std::string& state) { return digests.keccak.setState(state); } });
+  if (options.computeSha3)
+    states.push_back({ "SHA3-256",   [&] { return digests.sha3  .getState(); }, [&](const std::string& state) { return digests.sha3  .setState(state); } });
+  return true;
+}
+
+
+/// CRC32 of the last bytes before position: a heuristic for append-only files, only catches rewrites which change
+/// these bytes (earlier modifications, e.g. in the first block, go unnoticed)
+static bool getTailCrc(int handle, uint64_t position, std::string& crc)
+{
+  const size_t TailSize = 4096;
+  char tail[TailSize];
+  size_t numBytes = position < TailSize ? size_t(position) : TailSize;
+  if (pread(handle, tail, numBytes, off_t(position - numBytes)) != ssize_t(numBytes))
+    return false;
+
+  crc = CRC32()(tail, numBytes);
+  return true;
+}
+
+
+/// hash an append-only file, continue where the last run stopped (stored in checkpointFile)
+/** Checkpoint format (text):
+    digest checkpoint 1
+    file <device> <inode>
+    size <number of hashed bytes>
+    tail <CRC32 of the last 4096 bytes before size>
+    <tag> <internal state as hex>  (one line per hash)
+  */
+static bool tailFile(const std::string& filename, const std::string& checkpointFile, const Options& options,
+                     Digests& digests, std::string& error)
+{
+  std::vector<HashState> states;
+  if (!getHashStates(options, digests, states))
+  {
+    error = "--tail supports only CRC32, MD5, SHA1, SHA256, Keccak and SHA3";
+    return false;
+  }
+
+  int handle = open(filename.c_str(), O_RDONLY);
+  struct stat info;
+  if (handle < 0 || fstat(handle, &info) != 0 || !S_ISREG(info.st_mode))
+  {
+    if (handle >= 0)
+      close(handle);
+    error = "Can't open '" + filename + "'";
+    return false;
+  }
+
+  // restore state of the previous run
+  uint64_t position = 0;
+  std::ifstream checkpoint(checkpointFile.c_str(), std::ios::in | std::ios::binary);
+  if (checkpoint)
+  {
+    std::string     magic, fileKey, sizeKey, tailKey, tailCrc, currentCrc;
+    uint64_t        device = 0, inode = 0, size = 0;
+    unsigned int    version = 0;
+    checkpoint >> magic >> magic >> version >> fileKey >> device >> inode >> sizeKey >> size >> tailKey >> tailCrc;
+    bool valid = checkpoint && magic == "checkpoint" && version == 1 && fileKey == "file" && sizeKey == "size" && tailKey == "tail" &&
+                 device == uint64_t(info.st_dev) && inode == uint64_t(info.st_ino) &&
+                 size <= uint64_t(info.st_size) && getTailCrc(handle, size, currentCrc) && currentCrc == tailCrc;
+
+    // all selected hashes, same order
+    for (size_t i = 0; i < states.size() && valid; i++)
+    {
+      std::string tag, hex, state;
+      checkpoint >> tag >> hex;
+      valid = checkpoint && tag == states[i].tag && hexToBytes(hex, state) && states[i].set(state);
+    }
+    std::string unused;
+    valid = valid && !(checkpoint >> unused);
+
+    if (valid)
+      position = size;
+    else
+    {
+      digests.multiHash.reset();
+      static std::mutex noticeLock;
+      std::lock_guard<std::mutex> lock(noticeLock);
+      std::cerr << "'" << filename << "' doesn't match checkpoint '" << checkpointFile << "', hashing from the start" << std::endl;
+    }
+  }
+
+  // only new bytes
+  if (lseek(handle, off_t(position), SEEK_SET) < 0)
+  {
+    error = "Can't read '" + filename + "'";
+    close(handle);
+    return false;
+  }
+  AsyncReader reader(handle);
+  const void* data;
+  ptrdiff_t   numBytesRead;
+  while ((numBytesRead = reader.next(data)) > 0)
+  {
+    digests.multiHash.add(data, size_t(numBytesRead));
+    position += uint64_t(numBytesRead);
+  }
+
+  std::string tailCrc;
+  bool ok = numBytesRead == 0 && getTailCrc(handle, position, tailCrc);
+  close(handle);
+  if (!ok)
+  {
+    error = "Can't read '" + filename + "'";
+    return false;
+  }
+
+  // write new checkpoint to a temporary file first, a crash must not leave a truncated checkpoint behind
+  std::string temporary = checkpointFile + ".tmp";
+  std::ofstream output(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  output << "digest checkpoint 1\n"
+         << "file " << uint64_t(info.st_dev) << " " << uint64_t(info.st_ino) << "\n"
+         << "size " << position << "\n"
+         << "tail " << tailCrc << "\n";
+  for (size_t i = 0; i < states.size(); i++)
+    output << states[i].tag << " " << bytesToHex(states[i].get()) << "\n";
+  output.close();
+  if (!output || std::rename(temporary.c_str(), checkpointFile.c_str()) != 0)
+  {
+    std::remove(temporary.c_str());
+    error = "Can't write '" + checkpointFile + "'";
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+
+/// parse a non-negative decimal number, valid becomes false if it's not a number
+static uint64_t parseSize(const char* text, bool& valid)
+{
+  char* end = NULL;
+  uint64_t result = strtoull(text, &end, 10);
+  valid &= *text >= '0' && *text <= '9' && *end == 0;
+  return result;
+}
+
+
+/// "<tag> <offset> <length> <file size> <internal state as hex>  <filename>" of a range, only if options.isMergeable()
+/// (file size is "-" if unknown)
+static std::string formatPartial(const Options& options, Digests& digests, uint64_t offset, uint64_t numBytes,
+                                 uint64_t fileSize, const std::string& filename)
+{
+  std::string state, tag = getResults(options, digests)[0].tag;
+  if (options.computeCrc32)
+    state = digests.crc32.getState();
+  if (options.computeCrc64)
+    state = digests.crc64.getState();
+  if (options.computeTree)
+    state = digests.tree->getState();
+  std::string size = fileSize == ~uint64_t(0) ? "-" : std::to_string(fileSize);
+  return tag + " " + std::to_string(offset) + " " + std::to_string(numBytes) + " " + size + " " + bytesToHex(state) + "  " + filename + "\n";
+}
+
+
+/// merge results of ranges (produced by --partial) into the hashes of whole files, returns exit code
+static int mergePartials(const std::vector<std::string>& partialFiles, const Options& options)
+{
+  /// a line produced by formatPartial
+  struct Partial
+  {
+    uint64_t    offset;
+    uint64_t    numBytes;
+    uint64_t    fileSize; // ~0 if unknown
+    std::string state;
+    bool operator<(const Partial& other) const { return offset < other.offset; }
+  };
+
+  std::string tag;
+  {
+    Digests digests(options);
+    tag = getResults(options, digests)[0].tag;
+  }
+
+  // group by filename, keep order of first appearance
+  std::vector<std::string> filenames;
+  std::map<std::string, std::vector<Partial> > partials;
+  int exitCode = 0;
+  for (size_t i = 0; i < partialFiles.size(); i++)
+  {
+    std::ifstream file;
+    if (partialFiles[i] != "-")
+    {
+      file.open(partialFiles[i].c_str(), std::ios::in | std::ios::binary);
+      if (!file)
+      {
+        std::cerr << "Can't open '" << partialFiles[i] << "'" << std::endl;
+        exitCode = 2;
+        continue;
+      }
+    }
+    std::istream& input = partialFiles[i] == "-" ? std::cin : file;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+      if (line.empty())
+        continue;
+
+      // five fields separated by a single space, two spaces before the filename
+      size_t fields[5] = { 0, 0, 0, 0, 0 };
+      for (size_t field = 1; field < 5 && fields[field - 1] != std::string::npos; field++)
+        fields[field] = line.find(' ', fields[field - 1]) == std::string::npos ? std::string::npos : line.find(' ', fields[field - 1]) + 1;
+      size_t separator = fields[4] == std::string::npos ? std::string::npos : line.find("  ", fields[4]);
+
+      Partial partial;
+      char* end = NULL;
+      bool ok = separator != std::string::npos && line.compare(0, fields[1] - 1, tag) == 0;
+      if (ok)
+      {
+        partial.offset   = strtoull(line.c_str() + fields[1], &end, 10);
+        ok &= end == line.c_str() + fields[2] - 1;
+        partial.numBytes = strtoull(line.c_str() + fields[2], &end, 10);
+        ok &= end == line.c_str() + fields[3] - 1;
+        if (line.compare(fields[3], fields[4] - 1 - fields[3], "-") == 0)
+          partial.fileSize = ~uint64_t(0);
+        else
+        {
+          partial.fileSize = strtoull(line.c_str() + fields[3], &end, 10);
+          ok &= end == line.c_str() + fields[4] - 1;
+        }
+        ok &= hexToBytes(line.substr(fields[4], separator - fields[4]), partial.state);
+      }
+      if (!ok)
+      {
+        std::cerr << "Invalid " << tag << " partial result in '" << partialFiles[i] << "': " << line << std::endl;
+        exitCode = 2;
+        continue;
+      }
+
+      std::string filename = line.substr(separator + 2);
+      if (partials.find(filename) == partials.end())
+        filenames.push_back(filename);
+      partials[filename].push_back(partial);
+    }
+  }
+
+  // merge ranges in ascending order, they must be contiguous, start at the beginning of the file and reach its end
+  for (size_t i = 0; i < filenames.size(); i++)
+  {
+    std::vector<Partial>& ranges = partials[filenames[i]];
+    std::sort(ranges.begin(), ranges.end());
+
+    Digests  digests(options);
+    uint64_t position = 0;
+    std::string error;
+    for (size_t j = 0; j < ranges.size() && error.empty(); j++)
+    {
+      const Partial& range = ranges[j];
+      // all workers must have seen the same file
+      if (range.fileSize != ranges[0].fileSize)
+      {
+        error = "'" + filenames[i] + "': file size differs at offset " + std::to_string(range.offset);
+        break;
+      }
+      // workers behind the end of file
+      if (range.numBytes == 0)
+        continue;
+      if (range.offset != position)
+      {
+        error = "'" + filenames[i] + "': " + (range.offset < position ? "overlapping" : "missing") +
+                " range at offset " + std::to_string(std::min(range.offset, position));
+        break;
+      }
+
+      bool ok = false;
+      if (options.computeCrc32)
+      {
+        CRC32 crc32;
+        ok = crc32.setState(range.state) && crc32.getNumBytes() == range.numBytes;
+        digests.crc32.combine(crc32);
+      }
+      if (options.computeCrc64)
+      {
+        CRC64 crc64;
+        ok = crc64.setState(range.state) && crc64.getNumBytes() == range.numBytes;
+        digests.crc64.combine(crc64);
+      }
+      if (options.computeTree)
+      {
+        // subtrees must not cross range boundaries
+        SHA256Tree tree(options.leafSize);
+        ok = tree.setState(range.state) && tree.getNumBytes() == range.numBytes && digests.tree->combine(tree);
+      }
+      if (!ok)
+        error = "'" + filenames[i] + "': can't merge range at offset " + std::to_string(range.offset) +
+                " (different leaf size, not aligned or corrupted)";
+      position += range.numBytes;
+    }
+    // trailing ranges weren't hashed or their results are missing
+    if (error.empty() && ranges[0].fileSize != ~uint64_t(0) && position != ranges[0].fileSize)
+      error = "'" + filenames[i] + "': missing range at offset " + std::to_string(position);
+
+    if (!error.empty())
+    {
+      std::cerr << error << std::endl;
+      exitCode = 2;
+      continue;
+    }
+    std::cout << formatResults(getResults(options, digests), filenames[i]);
+  }
+
+  return exitCode;
+}
+
+
+int main(int argc, char** argv)
+{
+  // parameters: options start with "--", everything else is a file or a directory ("-" is standard-in)
+  std::string algorithm;
+  bool direct = false;
+  bool check  = false;
+  bool tee    = false;
+  std::string teeFile; // empty: standard-error
+  bool tail   = false;
+  std::string checkpointFile; // empty: filename + ".checkpoint"
+  bool ranged = false;
+  uint64_t offset = 0;
+  uint64_t length = ~uint64_t(0); // until end of file
+  bool partial = false;
+  bool merge  = false;
+  bool valid  = true;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--direct")
+      direct = true; // bypass the page cache
+    else if (arg == "-c" || arg == "--check")
+      check  = true; // verify checksum files
+    else if (arg.compare(0, 9, "--offset=") == 0)
+    {
+      ranged = true; // only a part of each file
+      offset = parseSize(arg.c_str() + 9, valid);
+    }
+    else if (arg.compare(0, 9, "--length=") == 0)
+    {
+      ranged = true;
+      length = parseSize(arg.c_str() + 9, valid);
+    }
+    else if (arg == "--partial")
+      partial = ranged = true; // print internal state to be merged later
+    else if (arg == "--merge")
+      merge  = true; // merge partial results
+    else if (arg == "--tail" || arg.compare(0, 7, "--tail=") == 0)
+    {
+      tail   = true; // append-only files
+      checkpointFile = arg.size() > 7 ? arg.substr(7) : "";
+    }
+    else if (arg == "--tee" || arg.compare(0, 6, "--tee=") == 0)
+    {
+      tee    = true; // pipe filter
+      teeFile = arg.size() > 6 ? arg.substr(6) : "";
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      // only one algorithm
+      valid &= algorithm.empty();
+      algorithm = arg;
+      // custom leaf size of the SHA256 Merkle tree
+      if (arg.compare(0, 7, "--tree=") == 0)
+      {
+        uint64_t leafSize = parseSize(arg.c_str() + 7, valid);
+        valid &= leafSize > 0 && leafSize <= SHA256Tree::MaxLeafSize;
+      }
+    }
+    else
+      paths.push_back(arg);
+  }
+
+  // syntax check
+  if (paths.empty() == !tee || int(tee) + int(check) + int(tail) + int(ranged) + int(merge) > 1 ||
+      (!checkpointFile.empty() && paths.size() > 1) || !valid)
+  {
+    std::cout << "./digest filename [filename|directory ...] [--crc|--crc32c|--crc64|--md5|--sha1|--sha256|--sha384|--sha512|--sha512-256|--keccak|--sha3|--tree[=leafsize]|--blake3] [--direct]" << std::endl;
+    std::cout << "./digest -c|--check checksumfile [...] [--algorithm] [--direct]" << std::endl;
+    std::cout << "./digest --tee[=digestfile] [--algorithm] < input > output" << std::endl;
+    std::cout << "./digest --tail[=checkpointfile] filename [...] [--algorithm]" << std::endl;
+    std::cout << "./digest filename [...] --offset=bytes --length=bytes [--partial] [--algorithm]" << std::endl;
+    std::cout << "./digest --merge partialfile [...] --crc|--crc64|--tree[=leafsize]" << std::endl;
+    return 1;
+  }
+
+  // verify checksum files
+  if (check)
+  {
+    int exitCode = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+      exitCode = std::max(exitCode, checkFiles(paths[i], algorithm, direct));
+    return exitCode;
+  }
+
+  Options options(algorithm, direct);
+
+  // only CRC32, CRC64 and SHA256 tree can be merged
+  if ((partial || merge) && !options.isMergeable())
+  {
+    std::cerr << "--partial and --merge require --crc, --crc64 or --tree[=leafsize]" << std::endl;
+    return 1;
+  }
+  if (merge)
+    return mergePartials(paths, options);
+
+  // hash a file or only a range of it (numBytes returns the size of the range)
+  auto hash = [&](const std::string& filename, Digests& digests, bool useThreads, uint64_t& numBytes, uint64_t& fileSize,
+                  std::string& error)
+  {
+#ifndef _MSC_VER
+    if (ranged)
+    {
+      numBytes = length;
+      return hashRange(filename, offset, numBytes, fileSize, options, digests, error);
+    }
+#endif
+    return hashFile(filename, options, digests, useThreads, error);
+  };
+
+#ifndef _MSC_VER
+  // append-only files: hash only what was appended since the last run
+  if (tail)
+  {
+    size_t numFailed = runOrdered(paths.size(), [&](size_t i, std::string& output, std::string& error)
+    {
+      Digests digests(options);
+      if (tailFile(paths[i], checkpointFile.empty() ? paths[i] + ".checkpoint" : checkpointFile, options, digests, error))
+        output = formatResults(getResults(options, digests), paths[i]);
+    });
+    return numFailed > 0 ? 2 : 0;
+  }
+#endif
+
+  // copy standard-in to standard-out, digest is written to standard-error or a file
+  if (tee)
+  {
+    Digests digests(options);
+    std::string error;
+    if (!teeStream(digests, error))
+    {
+      std::cerr << error << std::endl;
+      return 2;
+    }
+
+    std::string output = formatResults(getResults(options, digests), "-");
+    if (teeFile.empty())
+    {
+      std::cerr << output << std::flush;
+      return 0;
+    }
+
+    std::ofstream digestFile(teeFile.c_str(), std::ios::out | std::ios::binary);
+    digestFile << output;
+    digestFile.close();
+    if (!digestFile)
+    {
+      std::cerr << "Can't write '" << teeFile << "'" << std::endl;
+      return 2;
+    }
+    return 0;
+  }
+
+  // a single file: all hashes of this file may run in parallel
+  if (paths.size() == 1 && !isDirectory(paths[0]))
+  {
+    Digests digests(options);
+    std::string error;
+    uint64_t numBytes, fileSize;
+    if (!hash(paths[0], digests, true, numBytes, fileSize, error))
+    {
+      std::cerr << error << std::endl;
+      return 2;
+    }
+
+    if (partial)
+    {
+      std::cout << formatPartial(options, digests, offset, numBytes, fileSize, paths[0]);
+      return 0;
+    }
+
+    // show results
+    std::vector<Result> results = getResults(options, digests);
+    for (size_t i = 0; i < results.size(); i++)
+      std::cout << results[i].label << results[i].hash << std::endl;
+    return 0;
+  }
+
+  // several files and/or directories
+  int exitCode = 0;
+  std::vector<std::string> files;
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    if (!isDirectory(paths[i]))
+      files.push_back(paths[i]);
+#ifndef _MSC_VER
+    else if (!listDirectory(paths[i], files))
+      exitCode = 2;
+#endif
+  }
+
+  if (runOrdered(files.size(), [&](size_t i, std::string& output, std::string& error)
+      {
+        Digests  digests(options);
+        uint64_t numBytes, fileSize;
+        if (!hash(files[i], digests, false, numBytes, fileSize, error))
+          return;
+
+        output = partial ? formatPartial(options, digests, offset, numBytes, fileSize, files[i])
+                         : formatResults(getResults(options, digests), files[i]);
+      }) > 0)
+    exitCode = 2;
+
+  return exitCode;
 }
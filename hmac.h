@@ -30,7 +30,7 @@
 #include <string>
 #include <cstring> // memcpy
 
-/// compute HMAC hash of data and key using MD5, SHA1 or SHA256
+/// compute HMAC hash of data and key using MD5, SHA1, SHA256, SHA384 or SHA512
 template <typename HashMethod>
 std::string hmac(const void* data, size_t numDataBytes, const void* key, size_t numKeyBytes)
 {
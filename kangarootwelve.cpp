@@ -0,0 +1,254 @@
+// //////////////////////////////////////////////////////////
+// kangarootwelve.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "kangarootwelve.h"
+#include "threadpool.h"
+
+#include <cstring> // memcpy
+
+
+/// constants and local helper functions
+namespace
+{
+  /// TurboSHAKE128
+  const size_t       Rate   = 168;
+  const unsigned int Rounds = 12;
+
+  /// domain bytes
+  const uint8_t SingleNodeDomain = 0x07;
+  const uint8_t FinalNodeDomain  = 0x06;
+  const uint8_t LeafDomain       = 0x0B;
+
+  /// appended to the first chunk in tree mode
+  const uint8_t FirstChunkMarker[8] = { 0x03, 0, 0, 0, 0, 0, 0, 0 };
+  /// end of final node
+  const uint8_t FinalNodeEnd[2] = { 0xFF, 0xFF };
+
+  /// chunks processed by a single task (multiple of 4 for SIMD)
+  const size_t ChunksPerTask = 8;
+
+  /// RFC 9861 length_encode: big endian value without leading zeros, followed by number of bytes
+  std::string lengthEncode(uint64_t x)
+  {
+    std::string result;
+    for (; x > 0; x >>= 8)
+      result.insert(result.begin(), char(x & 0xFF));
+
+    result += char(result.size());
+    return result;
+  }
+}
+
+
+/// same as reset(), pool = NULL means ThreadPool::shared()
+KangarooTwelve::KangarooTwelve(size_t hashBytes, const std::string& customization, ThreadPool* pool)
+: m_hashBytes(hashBytes),
+  m_suffix(customization + lengthEncode(customization.size())),
+  m_pool(pool != NULL ? pool : &ThreadPool::shared()),
+  m_final(Rate, Rounds)
+{
+  // enough chunks to keep all threads busy
+  m_batchChunks = ChunksPerTask * m_pool->getNumThreads();
+  m_buffer.resize(m_batchChunks * ChunkSize);
+
+  reset();
+}
+
+
+/// restart
+void KangarooTwelve::reset()
+{
+  m_final.reset();
+  m_isTree     = false;
+  m_numChunks  = 0;
+  m_bufferSize = 0;
+}
+
+
+/// hash numChunks chunks in parallel and absorb their chaining values into sponge
+void KangarooTwelve::processChunks(const uint8_t* data, size_t numChunks, KeccakSponge& sponge) const
+{
+  std::vector<uint8_t> chaining(numChunks * ChainingBytes);
+
+  size_t numTasks = (numChunks + ChunksPerTask - 1) / ChunksPerTask;
+  m_pool->run(numTasks, [&](size_t task)
+  {
+    size_t first = task * ChunksPerTask;
+    size_t count = first + ChunksPerTask <= numChunks ? ChunksPerTask : numChunks - first;
+    keccakHashLeaves(data + first * ChunkSize, ChunkSize, count, Rate, Rounds, LeafDomain,
+                     &chaining[first * ChainingBytes], ChainingBytes);
+  });
+
+  sponge.add(&chaining[0], chaining.size());
+}
+
+
+/// first chunk is complete and more data follows: switch to tree hashing
+void KangarooTwelve::startTree(const uint8_t* firstChunk)
+{
+  m_final.add(firstChunk, ChunkSize);
+  m_final.add(FirstChunkMarker, sizeof(FirstChunkMarker));
+  m_isTree = true;
+}
+
+
+/// add arbitrary number of bytes
+void KangarooTwelve::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  // keep first chunk until it's clear whether a tree is needed
+  if (!m_isTree)
+  {
+    size_t copy = ChunkSize - m_bufferSize;
+    if (copy > numBytes)
+      copy = numBytes;
+    memcpy(&m_buffer[m_bufferSize], current, copy);
+    m_bufferSize += copy;
+    current      += copy;
+    numBytes     -= copy;
+
+    // no more data ? maybe the whole input fits into a single chunk
+    if (numBytes == 0)
+      return;
+
+    startTree(&m_buffer[0]);
+    m_bufferSize = 0;
+  }
+
+  size_t batchBytes = m_buffer.size();
+
+  // fill buffer
+  if (m_bufferSize > 0)
+  {
+    size_t copy = batchBytes - m_bufferSize;
+    if (copy > numBytes)
+      copy = numBytes;
+    memcpy(&m_buffer[m_bufferSize], current, copy);
+    m_bufferSize += copy;
+    current      += copy;
+    numBytes     -= copy;
+
+    // full buffer (the customization string guarantees that these chunks are never the last chunk)
+    if (m_bufferSize == batchBytes)
+    {
+      processChunks(&m_buffer[0], m_batchChunks, m_final);
+      m_numChunks += m_batchChunks;
+      m_bufferSize = 0;
+    }
+  }
+
+  // process full batches without copying them
+  while (numBytes >= batchBytes)
+  {
+    processChunks(current, m_batchChunks, m_final);
+    m_numChunks += m_batchChunks;
+    current     += batchBytes;
+    numBytes    -= batchBytes;
+  }
+
+  // keep remaining bytes in buffer
+  if (numBytes > 0)
+  {
+    memcpy(&m_buffer[m_bufferSize], current, numBytes);
+    m_bufferSize += numBytes;
+  }
+}
+
+
+/// return latest hash as hex characters
+std::string KangarooTwelve::getHash()
+{
+  // compute hash (as raw bytes)
+  std::vector<unsigned char> rawHash(m_hashBytes);
+  getHash(&rawHash[0]);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * m_hashBytes);
+  for (size_t i = 0; i < m_hashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes (hashBytes bytes)
+void KangarooTwelve::getHash(unsigned char* buffer)
+{
+  // remaining message bytes and customization
+  std::vector<uint8_t> tail(m_buffer.begin(), m_buffer.begin() + m_bufferSize);
+  tail.insert(tail.end(), m_suffix.begin(), m_suffix.end());
+
+  // work on a copy, so that more data can be added later
+  KeccakSponge final     = m_final;
+  uint64_t     numChunks = m_numChunks;
+
+  const uint8_t* current  = &tail[0];
+  size_t         numBytes = tail.size();
+  if (!m_isTree)
+  {
+    // short input: single node
+    if (numBytes <= ChunkSize)
+    {
+      KeccakSponge single(Rate, Rounds);
+      single.add(current, numBytes);
+      single.squeeze(SingleNodeDomain, buffer, m_hashBytes);
+      return;
+    }
+
+    final.add(current, ChunkSize);
+    final.add(FirstChunkMarker, sizeof(FirstChunkMarker));
+    current  += ChunkSize;
+    numBytes -= ChunkSize;
+  }
+
+  // full chunks
+  size_t numFull = numBytes / ChunkSize;
+  if (numFull > 0)
+    processChunks(current, numFull, final);
+  numChunks += numFull;
+  current   += numFull * ChunkSize;
+  numBytes  -= numFull * ChunkSize;
+
+  // last chunk
+  if (numBytes > 0)
+  {
+    uint8_t chaining[ChainingBytes];
+    KeccakSponge leaf(Rate, Rounds);
+    leaf.add(current, numBytes);
+    leaf.squeeze(LeafDomain, chaining, ChainingBytes);
+    final.add(chaining, ChainingBytes);
+    numChunks++;
+  }
+
+  std::string numChainingValues = lengthEncode(numChunks);
+  final.add(numChainingValues.c_str(), numChainingValues.size());
+  final.add(FinalNodeEnd, sizeof(FinalNodeEnd));
+  final.squeeze(FinalNodeDomain, buffer, m_hashBytes);
+}
+
+
+/// compute hash of a memory block
+std::string KangarooTwelve::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute hash of a string, excluding final zero
+std::string KangarooTwelve::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
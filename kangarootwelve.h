@@ -0,0 +1,85 @@
+// //////////////////////////////////////////////////////////
+// kangarootwelve.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include "keccakp.h"
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+
+/// compute KangarooTwelve hash (KT128, RFC 9861)
+/** Usage:
+    KangarooTwelve k12;
+    std::string myHash  = k12("Hello World");     // std::string
+    std::string myHash2 = k12("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    KangarooTwelve k12(64, "my customization");   // 64 bytes output
+    while (more data available)
+      k12.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = k12.getHash();
+
+    Note:
+    Chunks of 8 KB are hashed in parallel, on all threads of the thread pool
+    and four chunks at once per thread (SIMD).
+  */
+class KangarooTwelve //: public Hash
+{
+public:
+  /// 8 KB chunks, 32 bytes chaining values, default output is 32 bytes
+  enum { ChunkSize = 8192, ChainingBytes = 32, DefaultHashBytes = 32 };
+
+  /// same as reset(), pool = NULL means ThreadPool::shared()
+  explicit KangarooTwelve(size_t hashBytes = DefaultHashBytes, const std::string& customization = "",
+                          ThreadPool* pool = NULL);
+
+  /// compute hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as hex characters
+  std::string getHash();
+  /// return latest hash as bytes (hashBytes bytes)
+  void        getHash(unsigned char* buffer);
+
+  /// restart
+  void reset();
+
+private:
+  /// hash numChunks chunks in parallel and absorb their chaining values into sponge
+  void processChunks(const uint8_t* data, size_t numChunks, KeccakSponge& sponge) const;
+  /// first chunk is complete and more data follows: switch to tree hashing
+  void startTree(const uint8_t* firstChunk);
+
+  /// output length
+  size_t       m_hashBytes;
+  /// customization string followed by its length_encode
+  std::string  m_suffix;
+  /// workers
+  ThreadPool*  m_pool;
+  /// chunks per batch
+  size_t       m_batchChunks;
+
+  /// final node (only valid if m_isTree is true)
+  KeccakSponge m_final;
+  /// true if input exceeds a single chunk
+  bool         m_isTree;
+  /// number of chaining values absorbed by m_final
+  uint64_t     m_numChunks;
+  /// chunks not processed yet (without tree: the first chunk)
+  std::vector<uint8_t> m_buffer;
+  /// valid bytes in m_buffer
+  size_t       m_bufferSize;
+};
@@ -232,51 +232,48 @@ void Keccak::processBuffer()
 }
 
 
-/// return latest hash as 16 hex characters
+/// return latest hash as hex characters
 std::string Keccak::getHash()
 {
-  // save hash state
-  uint64_t oldHash[StateSize];
-  for (unsigned int i = 0; i < StateSize; i++)
-    oldHash[i] = m_hash[i];
-
-  // process remaining bytes
-  processBuffer();
+  // no more than 512 bits
+  unsigned char rawHash[512 / 8];
+  getHash(rawHash);
 
   // convert hash to string
   static const char dec2hex[16 + 1] = "0123456789abcdef";
 
-  // number of significant elements in hash (uint64_t)
-  unsigned int hashLength = m_bits / 64;
-
   std::string result;
-  for (unsigned int i = 0; i < hashLength; i++)
-    for (unsigned int j = 0; j < 8; j++) // 64 bits => 8 bytes
-    {
-      // convert a byte to hex
-      unsigned char oneByte = (unsigned char) (m_hash[i] >> (8 * j));
-      result += dec2hex[oneByte >> 4];
-      result += dec2hex[oneByte & 15];
-    }
-
-  // Keccak224's last entry in m_hash provides only 32 bits instead of 64 bits
-  unsigned int remainder = m_bits - hashLength * 64;
-  unsigned int processed = 0;
-  while (processed < remainder)
+  unsigned int hashBytes = m_bits / 8;
+  for (unsigned int i = 0; i < hashBytes; i++)
   {
     // convert a byte to hex
-    unsigned char oneByte = (unsigned char) (m_hash[hashLength] >> processed);
-    result += dec2hex[oneByte >> 4];
-    result += dec2hex[oneByte & 15];
-
-    processed += 8;
+    result += dec2hex[rawHash[i] >> 4];
+    result += dec2hex[rawHash[i] & 15];
   }
 
+  return result;
+}
+
+
+/// return latest hash as bytes (m_bits / 8 bytes)
+void Keccak::getHash(unsigned char* buffer)
+{
+  // save hash state
+  uint64_t oldHash[StateSize];
+  for (unsigned int i = 0; i < StateSize; i++)
+    oldHash[i] = m_hash[i];
+
+  // process remaining bytes
+  processBuffer();
+
+  // little endian, Keccak224's last entry in m_hash provides only 32 bits instead of 64 bits
+  unsigned int hashBytes = m_bits / 8;
+  for (unsigned int i = 0; i < hashBytes; i++)
+    buffer[i] = (unsigned char) (m_hash[i / 8] >> (8 * (i % 8)));
+
   // restore state
   for (unsigned int i = 0; i < StateSize; i++)
     m_hash[i] = oldHash[i];
-
-  return result;
 }
 
 
@@ -296,3 +293,47 @@ std::string Keccak::operator()(const std::string& text)
   add(text.c_str(), text.size());
   return getHash();
 }
+
+
+/// export internal state: number of bytes, 25 lanes and unprocessed bytes (little endian)
+std::string Keccak::getState() const
+{
+  std::string state;
+  uint64_t numBytes = m_numBytes + m_bufferSize;
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(numBytes >> shift);
+  for (unsigned int i = 0; i < StateSize; i++)
+    for (int shift = 0; shift < 64; shift += 8)
+      state += char(m_hash[i] >> shift);
+  state.append((const char*) m_buffer, m_bufferSize);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid
+bool Keccak::setState(const std::string& state)
+{
+  const size_t HeaderSize = 8 + 8 * StateSize;
+  if (state.size() < HeaderSize)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  uint64_t numBytes = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    numBytes |= uint64_t(*current++) << shift;
+  if (state.size() != HeaderSize + numBytes % m_blockSize)
+    return false;
+
+  for (unsigned int i = 0; i < StateSize; i++)
+  {
+    m_hash[i] = 0;
+    for (int shift = 0; shift < 64; shift += 8)
+      m_hash[i] |= uint64_t(*current++) << shift;
+  }
+
+  m_bufferSize = size_t(numBytes % m_blockSize);
+  m_numBytes   = numBytes - m_bufferSize;
+  for (size_t i = 0; i < m_bufferSize; i++)
+    m_buffer[i] = current[i];
+  return true;
+}
@@ -52,10 +52,17 @@ public:
 
   /// return latest hash as hex characters
   std::string getHash();
+  /// return latest hash as bytes (bits / 8 bytes)
+  void        getHash(unsigned char* buffer);
 
   /// restart
   void reset();
 
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
 private:
   /// process a full block
   void processBlock(const void* data);
@@ -0,0 +1,382 @@
+// //////////////////////////////////////////////////////////
+// keccakp.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "keccakp.h"
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#include <cstring> // memcpy
+
+
+// GCC and Clang can process four states in parallel with their vector extensions
+#if defined(__GNUC__) || defined(__clang__)
+#define KECCAK_SIMD
+typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+#define KECCAK_INLINE inline __attribute__((always_inline))
+// build an AVX2 and a generic version of the four-way permutation, pick the right one at runtime
+#if defined(__x86_64__) && defined(__linux__) && !defined(__clang__)
+#define KECCAK_MULTIVERSION __attribute__((target_clones("avx2", "default")))
+#endif
+#else
+#define KECCAK_INLINE inline
+#endif
+#ifndef KECCAK_MULTIVERSION
+#define KECCAK_MULTIVERSION
+#endif
+
+
+/// constants and local helper functions
+namespace
+{
+  const unsigned int MaxRounds = 24;
+  const uint64_t XorMasks[MaxRounds] =
+  {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+  };
+
+  /// convert litte vs big endian
+  inline uint64_t swap(uint64_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
+#endif
+#ifdef _MSC_VER
+    return _byteswap_uint64(x);
+#endif
+
+    return  (x >> 56) |
+           ((x >> 40) & 0x000000000000FF00ULL) |
+           ((x >> 24) & 0x0000000000FF0000ULL) |
+           ((x >>  8) & 0x00000000FF000000ULL) |
+           ((x <<  8) & 0x000000FF00000000ULL) |
+           ((x << 24) & 0x0000FF0000000000ULL) |
+           ((x << 40) & 0x00FF000000000000ULL) |
+            (x << 56);
+  }
+
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+#define LITTLEENDIAN(x) swap(x)
+#else
+#define LITTLEENDIAN(x) (x)
+#endif
+
+  /// read 8 bytes, may be unaligned
+  inline uint64_t load64(const uint8_t* data)
+  {
+    uint64_t result;
+    memcpy(&result, data, 8);
+    return LITTLEENDIAN(result);
+  }
+
+  /// return x % 5 for 0 <= x <= 9
+  inline unsigned int mod5(unsigned int x)
+  {
+    if (x < 5)
+      return x;
+
+    return x - 5;
+  }
+
+  /// rotate left and wrap around to the right (works for scalars and vectors)
+#define ROTATELEFT(x, numBits) (((x) << (numBits)) | ((x) >> (64 - (numBits))))
+
+  /// Keccak-p[1600, numRounds], Lane is either uint64_t or a vector of uint64_t
+  template <typename Lane>
+  KECCAK_INLINE void permute(Lane* state, unsigned int numRounds)
+  {
+    // Keccak-p uses the last numRounds rounds of Keccak-f
+    for (unsigned int round = MaxRounds - numRounds; round < MaxRounds; round++)
+    {
+      // Theta
+      Lane coefficients[5];
+      for (unsigned int i = 0; i < 5; i++)
+        coefficients[i] = state[i] ^ state[i + 5] ^ state[i + 10] ^ state[i + 15] ^ state[i + 20];
+
+      for (unsigned int i = 0; i < 5; i++)
+      {
+        Lane one = coefficients[mod5(i + 4)] ^ ROTATELEFT(coefficients[mod5(i + 1)], 1);
+        state[i     ] ^= one;
+        state[i +  5] ^= one;
+        state[i + 10] ^= one;
+        state[i + 15] ^= one;
+        state[i + 20] ^= one;
+      }
+
+      // temporary
+      Lane one;
+
+      // Rho Pi
+      Lane last = state[1];
+      one = state[10]; state[10] = ROTATELEFT(last,  1); last = one;
+      one = state[ 7]; state[ 7] = ROTATELEFT(last,  3); last = one;
+      one = state[11]; state[11] = ROTATELEFT(last,  6); last = one;
+      one = state[17]; state[17] = ROTATELEFT(last, 10); last = one;
+      one = state[18]; state[18] = ROTATELEFT(last, 15); last = one;
+      one = state[ 3]; state[ 3] = ROTATELEFT(last, 21); last = one;
+      one = state[ 5]; state[ 5] = ROTATELEFT(last, 28); last = one;
+      one = state[16]; state[16] = ROTATELEFT(last, 36); last = one;
+      one = state[ 8]; state[ 8] = ROTATELEFT(last, 45); last = one;
+      one = state[21]; state[21] = ROTATELEFT(last, 55); last = one;
+      one = state[24]; state[24] = ROTATELEFT(last,  2); last = one;
+      one = state[ 4]; state[ 4] = ROTATELEFT(last, 14); last = one;
+      one = state[15]; state[15] = ROTATELEFT(last, 27); last = one;
+      one = state[23]; state[23] = ROTATELEFT(last, 41); last = one;
+      one = state[19]; state[19] = ROTATELEFT(last, 56); last = one;
+      one = state[13]; state[13] = ROTATELEFT(last,  8); last = one;
+      one = state[12]; state[12] = ROTATELEFT(last, 25); last = one;
+      one = state[ 2]; state[ 2] = ROTATELEFT(last, 43); last = one;
+      one = state[20]; state[20] = ROTATELEFT(last, 62); last = one;
+      one = state[14]; state[14] = ROTATELEFT(last, 18); last = one;
+      one = state[22]; state[22] = ROTATELEFT(last, 39); last = one;
+      one = state[ 9]; state[ 9] = ROTATELEFT(last, 61); last = one;
+      one = state[ 6]; state[ 6] = ROTATELEFT(last, 20); last = one;
+                       state[ 1] = ROTATELEFT(last, 44);
+
+      // Chi
+      for (unsigned int j = 0; j < 25; j += 5)
+      {
+        // temporaries
+        Lane one = state[j];
+        Lane two = state[j + 1];
+
+        state[j]     ^= state[j + 2] & ~two;
+        state[j + 1] ^= state[j + 3] & ~state[j + 2];
+        state[j + 2] ^= state[j + 4] & ~state[j + 3];
+        state[j + 3] ^=     one      & ~state[j + 4];
+        state[j + 4] ^=     two      & ~one;
+      }
+
+      // Iota
+      state[0] ^= XorMasks[round];
+    }
+  }
+
+#ifdef KECCAK_SIMD
+  /// four independent states, each vector holds the same lane of all four states
+  KECCAK_MULTIVERSION
+  void permute4(Lanes4 state[25], unsigned int numRounds)
+  {
+    permute(state, numRounds);
+  }
+
+  /// hash four leaves of leafSize bytes each
+  void hashFourLeaves(const uint8_t* data, size_t leafSize, size_t rate, unsigned int numRounds, uint8_t domain,
+                      uint8_t* output, size_t outputBytes)
+  {
+    const Lanes4 zero = { 0, 0, 0, 0 };
+    Lanes4 state[25];
+    for (unsigned int i = 0; i < 25; i++)
+      state[i] = zero;
+
+    const uint8_t* leaf[4] = { data, data + leafSize, data + 2 * leafSize, data + 3 * leafSize };
+
+    // process full blocks
+    size_t processed = 0;
+    for (; processed + rate <= leafSize; processed += rate)
+    {
+      for (unsigned int i = 0; i < rate / 8; i++)
+      {
+        Lanes4 words = { load64(leaf[0] + processed + 8*i), load64(leaf[1] + processed + 8*i),
+                         load64(leaf[2] + processed + 8*i), load64(leaf[3] + processed + 8*i) };
+        state[i] ^= words;
+      }
+      permute4(state, numRounds);
+    }
+
+    // final block with padding
+    uint8_t padded[4][KeccakSponge::MaxRate];
+    size_t remaining = leafSize - processed;
+    for (unsigned int j = 0; j < 4; j++)
+    {
+      memcpy(padded[j], leaf[j] + processed, remaining);
+      memset(padded[j] + remaining, 0, rate - remaining);
+      padded[j][remaining] = domain;
+      padded[j][rate - 1] |= 0x80;
+    }
+    for (unsigned int i = 0; i < rate / 8; i++)
+    {
+      Lanes4 words = { load64(padded[0] + 8*i), load64(padded[1] + 8*i),
+                       load64(padded[2] + 8*i), load64(padded[3] + 8*i) };
+      state[i] ^= words;
+    }
+    permute4(state, numRounds);
+
+    // squeeze (little endian)
+    for (unsigned int j = 0; j < 4; j++)
+      for (size_t i = 0; i < outputBytes; i++)
+        output[j * outputBytes + i] = (uint8_t)(state[i / 8][j] >> (8 * (i % 8)));
+  }
+#endif
+}
+
+
+/// Keccak-p[1600, numRounds] permutation (24 rounds => Keccak-f[1600] as used by SHA3)
+void keccakPermutation(uint64_t state[25], unsigned int numRounds)
+{
+  permute(state, numRounds);
+}
+
+
+/// absorb numLeaves independent messages of leafSize bytes each (stored consecutively),
+/// append domain byte and padding and squeeze outputBytes (no more than rate) per message
+void keccakHashLeaves(const uint8_t* data, size_t leafSize, size_t numLeaves,
+                      size_t rate, unsigned int numRounds, uint8_t domain,
+                      uint8_t* output, size_t outputBytes)
+{
+#ifdef KECCAK_SIMD
+  // four leaves at once
+  for (; numLeaves >= 4; numLeaves -= 4)
+  {
+    hashFourLeaves(data, leafSize, rate, numRounds, domain, output, outputBytes);
+    data   += 4 * leafSize;
+    output += 4 * outputBytes;
+  }
+#endif
+
+  // one by one
+  KeccakSponge sponge(rate, numRounds);
+  for (; numLeaves > 0; numLeaves--)
+  {
+    sponge.reset();
+    sponge.add(data, leafSize);
+    sponge.squeeze(domain, output, outputBytes);
+    data   += leafSize;
+    output += outputBytes;
+  }
+}
+
+
+/// same as reset(), rate in bytes must be a multiple of 8
+KeccakSponge::KeccakSponge(size_t rate, unsigned int numRounds)
+: m_rate(rate),
+  m_rounds(numRounds)
+{
+  reset();
+}
+
+
+/// restart
+void KeccakSponge::reset()
+{
+  for (size_t i = 0; i < StateSize; i++)
+    m_state[i] = 0;
+
+  m_bufferSize = 0;
+}
+
+
+/// add arbitrary number of bytes
+void KeccakSponge::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  // copy data to buffer
+  if (m_bufferSize > 0)
+  {
+    while (numBytes > 0 && m_bufferSize < m_rate)
+    {
+      m_buffer[m_bufferSize++] = *current++;
+      numBytes--;
+    }
+
+    // full buffer
+    if (m_bufferSize < m_rate)
+      return;
+
+    for (size_t i = 0; i < m_rate / 8; i++)
+      m_state[i] ^= load64(m_buffer + 8*i);
+    permute(m_state, m_rounds);
+    m_bufferSize = 0;
+  }
+
+  // process full blocks
+  while (numBytes >= m_rate)
+  {
+    for (size_t i = 0; i < m_rate / 8; i++)
+      m_state[i] ^= load64(current + 8*i);
+    permute(m_state, m_rounds);
+
+    current  += m_rate;
+    numBytes -= m_rate;
+  }
+
+  // keep remaining bytes in buffer
+  memcpy(m_buffer, current, numBytes);
+  m_bufferSize = numBytes;
+}
+
+
+/// append domain byte and padding and write numBytes to output, state remains unchanged
+void KeccakSponge::squeeze(uint8_t domain, void* output, size_t numBytes) const
+{
+  // work on a copy
+  uint64_t state[StateSize];
+  for (size_t i = 0; i < StateSize; i++)
+    state[i] = m_state[i];
+
+  // padding
+  uint8_t padded[MaxRate];
+  memcpy(padded, m_buffer, m_bufferSize);
+  memset(padded + m_bufferSize, 0, m_rate - m_bufferSize);
+  padded[m_bufferSize] = domain;
+  padded[m_rate - 1]  |= 0x80;
+
+  for (size_t i = 0; i < m_rate / 8; i++)
+    state[i] ^= load64(padded + 8*i);
+  permute(state, m_rounds);
+
+  // squeeze as many blocks as needed (little endian)
+  uint8_t* current = (uint8_t*) output;
+  for (;;)
+  {
+    for (size_t i = 0; i < m_rate && numBytes > 0; i++, numBytes--)
+      *current++ = (uint8_t)(state[i / 8] >> (8 * (i % 8)));
+
+    if (numBytes == 0)
+      break;
+
+    permute(state, m_rounds);
+  }
+}
+
+
+/// export internal state: 25 lanes and unprocessed bytes (little endian)
+std::string KeccakSponge::getState() const
+{
+  std::string state;
+  for (size_t i = 0; i < StateSize; i++)
+    for (int shift = 0; shift < 64; shift += 8)
+      state += char(m_state[i] >> shift);
+  state.append((const char*) m_buffer, m_bufferSize);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid
+bool KeccakSponge::setState(const std::string& state)
+{
+  // less than a full block may be pending
+  if (state.size() < 8 * StateSize || state.size() >= 8 * StateSize + m_rate)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  for (size_t i = 0; i < StateSize; i++, current += 8)
+    m_state[i] = load64(current);
+
+  m_bufferSize = state.size() - 8 * StateSize;
+  memcpy(m_buffer, current, m_bufferSize);
+  return true;
+}
@@ -0,0 +1,78 @@
+// //////////////////////////////////////////////////////////
+// keccakp.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// Keccak-p[1600, numRounds] permutation (24 rounds => Keccak-f[1600] as used by SHA3)
+/** state consists of 25 lanes, lane[x + 5*y]
+    numRounds must not exceed 24, it's 12 for TurboSHAKE and KangarooTwelve (RFC 9861).
+    A reduced number of rounds runs the last rounds of Keccak-f[1600]. */
+void keccakPermutation(uint64_t state[25], unsigned int numRounds = 24);
+
+/// absorb numLeaves independent messages of leafSize bytes each (stored consecutively),
+/// append domain byte and padding and squeeze outputBytes (no more than rate) per message
+/** Four messages are processed at once by a SIMD permutation if the compiler supports vector extensions.
+    output receives numLeaves * outputBytes bytes. */
+void keccakHashLeaves(const uint8_t* data, size_t leafSize, size_t numLeaves,
+                      size_t rate, unsigned int numRounds, uint8_t domain,
+                      uint8_t* output, size_t outputBytes);
+
+
+/// simple sponge construction with arbitrary rate, round count and domain separation
+/** Usage:
+    KeccakSponge shake128(168);
+    shake128.add(data, numBytes);
+    shake128.squeeze(0x1F, output, 32); // SHAKE128's domain byte is 0x1F
+  */
+class KeccakSponge
+{
+public:
+  /// 1600 bits, stored as 25x64 bit
+  enum { StateSize = 1600 / (8 * 8), MaxRate = 1600 / 8 };
+
+  /// same as reset(), rate in bytes must be a multiple of 8
+  explicit KeccakSponge(size_t rate, unsigned int numRounds = 24);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// append domain byte and padding and write numBytes to output, state remains unchanged
+  void squeeze(uint8_t domain, void* output, size_t numBytes) const;
+
+  /// restart
+  void reset();
+
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
+private:
+  /// state
+  uint64_t     m_state[StateSize];
+  /// block size in bytes
+  size_t       m_rate;
+  /// number of rounds of the permutation
+  unsigned int m_rounds;
+  /// valid bytes in m_buffer
+  size_t       m_bufferSize;
+  /// bytes not processed yet
+  uint8_t      m_buffer[MaxRate];
+};
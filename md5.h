@@ -61,6 +61,11 @@ public:
   /// restart
   void reset();
 
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
 private:
   /// process everything left in the internal buffer
   void processBuffer();
@@ -0,0 +1,68 @@
+// //////////////////////////////////////////////////////////
+// multihash.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "multihash.h"
+
+
+/// tileSize should be less than the L1 cache
+MultiHash::MultiHash(size_t tileSize)
+: m_tileSize(tileSize > 0 ? tileSize : size_t(DefaultTileSize)),
+  m_numBytes(0)
+{
+}
+
+
+/// add arbitrary number of bytes to all hashes
+void MultiHash::add(const void* data, size_t numBytes)
+{
+  // a single hash doesn't benefit from tiling
+  if (m_hashes.size() == 1)
+  {
+    m_hashes[0].add(m_hashes[0].hash, data, numBytes);
+    m_numBytes += numBytes;
+    return;
+  }
+
+  const unsigned char* current = (const unsigned char*) data;
+  while (numBytes > 0)
+  {
+    // finish a tile which was started by a previous call
+    size_t numTile = m_tileSize - size_t(m_numBytes % m_tileSize);
+    if (numTile > numBytes)
+      numTile = numBytes;
+
+    // first hash loads the tile into the L1 cache, all others read it from there
+    for (size_t i = 0; i < m_hashes.size(); i++)
+      m_hashes[i].add(m_hashes[i].hash, current, numTile);
+
+    current    += numTile;
+    numBytes   -= numTile;
+    m_numBytes += numTile;
+  }
+}
+
+
+/// add arbitrary number of bytes to a single hash, e.g. when each hash runs on its own thread
+void MultiHash::addSingle(size_t index, const void* data, size_t numBytes)
+{
+  m_hashes[index].add(m_hashes[index].hash, data, numBytes);
+}
+
+
+/// reset all hashes
+void MultiHash::reset()
+{
+  for (size_t i = 0; i < m_hashes.size(); i++)
+    m_hashes[i].reset(m_hashes[i].hash);
+  m_numBytes = 0;
+}
+
+
+/// number of attached hashes
+size_t MultiHash::getNumHashes() const
+{
+  return m_hashes.size();
+}
@@ -0,0 +1,103 @@
+// //////////////////////////////////////////////////////////
+// multihash.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// feed the same data to several hashes, tile by tile so that each tile stays in the L1 cache
+/** Usage:
+    CRC32  crc32;
+    SHA256 sha256;
+    SHA3   sha3;
+    MultiHash multi;
+    multi.attach(crc32);
+    multi.attach(sha256);
+    multi.attach(sha3);
+    while (more data available)
+      multi.add(pointer to fresh data, number of new bytes);
+    std::string myHash1 = crc32.getHash();
+    std::string myHash2 = sha256.getHash();
+    std::string myHash3 = sha3.getHash();
+
+    Note:
+    Hashes aren't owned by MultiHash, they just need add(data, numBytes) and reset().
+    Tiles are aligned to the total stream position, so blocks of all hashes start at tile boundaries
+    and the hashes never have to copy partial blocks into their internal buffers.
+    Multi-threaded hashes (SHA256Tree, BLAKE3 with a thread pool) prefer large chunks and shouldn't be attached.
+  */
+class MultiHash
+{
+public:
+  /// 19584 bytes = 128 * 9 * 17: a multiple of 64, 72, 128, 136 and 144 (block sizes of MD5, SHA1, SHA2 and
+  /// SHA3/Keccak-512, -256, -224), but not of the 104 bytes of SHA3/Keccak-384
+  enum { DefaultTileSize = 128 * 9 * 17 };
+
+  /// tileSize should be less than the L1 cache
+  explicit MultiHash(size_t tileSize = DefaultTileSize);
+
+  /// add a hash (must be alive as long as MultiHash is in use)
+  template <typename HashMethod>
+  void attach(HashMethod& hash)
+  {
+    Entry entry;
+    entry.hash  = &hash;
+    entry.add   = &addThunk  <HashMethod>;
+    entry.reset = &resetThunk<HashMethod>;
+    m_hashes.push_back(entry);
+  }
+
+  /// add arbitrary number of bytes to all hashes
+  void add(const void* data, size_t numBytes);
+  /// add arbitrary number of bytes to a single hash, e.g. when each hash runs on its own thread
+  void addSingle(size_t index, const void* data, size_t numBytes);
+
+  /// reset all hashes
+  void reset();
+
+  /// number of attached hashes
+  size_t getNumHashes() const;
+
+private:
+  /// type-erased hash
+  struct Entry
+  {
+    void* hash;
+    void (*add)  (void* hash, const void* data, size_t numBytes);
+    void (*reset)(void* hash);
+  };
+
+  /// call HashMethod::add
+  template <typename HashMethod>
+  static void addThunk(void* hash, const void* data, size_t numBytes)
+  {
+    static_cast<HashMethod*>(hash)->add(data, numBytes);
+  }
+  /// call HashMethod::reset
+  template <typename HashMethod>
+  static void resetThunk(void* hash)
+  {
+    static_cast<HashMethod*>(hash)->reset();
+  }
+
+  /// all hashes
+  std::vector<Entry> m_hashes;
+  /// bytes per tile
+  size_t   m_tileSize;
+  /// size of processed data in bytes (only add(), not addSingle())
+  uint64_t m_numBytes;
+};
@@ -0,0 +1,223 @@
+// //////////////////////////////////////////////////////////
+// parallelhash.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "parallelhash.h"
+#include "threadpool.h"
+
+#include <cstring> // memcpy
+
+
+/// local helper functions
+namespace
+{
+  /// SHAKE's domain byte (plain SHAKE is used for each block)
+  const uint8_t ShakeDomain  = 0x1F;
+  /// cSHAKE's domain byte
+  const uint8_t CShakeDomain = 0x04;
+
+  /// blocks processed by a single task (multiple of 4 for SIMD)
+  const size_t BlocksPerTask = 16;
+
+  /// SP 800-185 left_encode: number of bytes followed by big endian value
+  std::string leftEncode(uint64_t x)
+  {
+    std::string result;
+    do
+    {
+      result.insert(result.begin(), char(x & 0xFF));
+      x >>= 8;
+    } while (x > 0);
+
+    result.insert(result.begin(), char(result.size()));
+    return result;
+  }
+
+  /// SP 800-185 right_encode: big endian value followed by number of bytes
+  std::string rightEncode(uint64_t x)
+  {
+    std::string result = leftEncode(x);
+    result.erase(result.begin());
+    result += char(result.size());
+    return result;
+  }
+
+  /// SP 800-185 encode_string
+  std::string encodeString(const std::string& text)
+  {
+    return leftEncode(8 * uint64_t(text.size())) + text;
+  }
+}
+
+
+/// same as reset(), outputBits = 0 means twice the security strength, pool = NULL means ThreadPool::shared()
+ParallelHash::ParallelHash(Bits bits, size_t blockSize, size_t outputBits, const std::string& customization, ThreadPool* pool)
+: m_bits(bits),
+  m_blockSize(blockSize > 0 ? blockSize : 8192),
+  m_outputBits(outputBits > 0 ? outputBits : 2 * bits),
+  m_pool(pool != NULL ? pool : &ThreadPool::shared()),
+  m_sponge(200 - 2 * (bits / 8))
+{
+  // cSHAKE's bytepad(encode_string(N) || encode_string(S), rate)
+  size_t rate = 200 - 2 * (bits / 8);
+  m_prefix = leftEncode(rate) + encodeString("ParallelHash") + encodeString(customization);
+  while (m_prefix.size() % rate != 0)
+    m_prefix += char(0);
+  // start of ParallelHash's input
+  m_prefix += leftEncode(m_blockSize);
+
+  // enough blocks to keep all threads busy
+  m_batchBlocks = BlocksPerTask * m_pool->getNumThreads();
+  m_buffer.resize(m_batchBlocks * m_blockSize);
+
+  reset();
+}
+
+
+/// restart
+void ParallelHash::reset()
+{
+  m_sponge.reset();
+  m_sponge.add(m_prefix.c_str(), m_prefix.size());
+
+  m_numBlocks  = 0;
+  m_bufferSize = 0;
+}
+
+
+/// hash numBlocks blocks in parallel and absorb their chaining values
+void ParallelHash::processBlocks(const uint8_t* data, size_t numBlocks)
+{
+  size_t chainingBytes = 2 * m_bits / 8;
+  std::vector<uint8_t> chaining(numBlocks * chainingBytes);
+
+  size_t numTasks  = (numBlocks + BlocksPerTask - 1) / BlocksPerTask;
+  size_t blockSize = m_blockSize;
+  size_t rate      = 200 - 2 * (m_bits / 8);
+  m_pool->run(numTasks, [&](size_t task)
+  {
+    size_t first = task * BlocksPerTask;
+    size_t count = first + BlocksPerTask <= numBlocks ? BlocksPerTask : numBlocks - first;
+    keccakHashLeaves(data + first * blockSize, blockSize, count, rate, 24, ShakeDomain,
+                     &chaining[first * chainingBytes], chainingBytes);
+  });
+
+  m_sponge.add(&chaining[0], chaining.size());
+  m_numBlocks += numBlocks;
+}
+
+
+/// add arbitrary number of bytes
+void ParallelHash::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  size_t batchBytes = m_buffer.size();
+
+  // fill buffer
+  if (m_bufferSize > 0)
+  {
+    size_t copy = batchBytes - m_bufferSize;
+    if (copy > numBytes)
+      copy = numBytes;
+    memcpy(&m_buffer[m_bufferSize], current, copy);
+    m_bufferSize += copy;
+    current      += copy;
+    numBytes     -= copy;
+
+    // full buffer
+    if (m_bufferSize == batchBytes)
+    {
+      processBlocks(&m_buffer[0], m_batchBlocks);
+      m_bufferSize = 0;
+    }
+  }
+
+  // process full batches without copying them
+  while (numBytes >= batchBytes)
+  {
+    processBlocks(current, m_batchBlocks);
+    current  += batchBytes;
+    numBytes -= batchBytes;
+  }
+
+  // keep remaining bytes in buffer
+  if (numBytes > 0)
+  {
+    memcpy(&m_buffer[m_bufferSize], current, numBytes);
+    m_bufferSize += numBytes;
+  }
+}
+
+
+/// return latest hash as hex characters
+std::string ParallelHash::getHash()
+{
+  // compute hash (as raw bytes)
+  std::vector<unsigned char> rawHash(m_outputBits / 8);
+  getHash(&rawHash[0]);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * rawHash.size());
+  for (size_t i = 0; i < rawHash.size(); i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes (outputBits / 8 bytes)
+void ParallelHash::getHash(unsigned char* buffer)
+{
+  // save state
+  KeccakSponge oldSponge    = m_sponge;
+  uint64_t     oldNumBlocks = m_numBlocks;
+
+  // process remaining blocks, the last one may be incomplete
+  size_t numFull = m_bufferSize / m_blockSize;
+  if (numFull > 0)
+    processBlocks(&m_buffer[0], numFull);
+  size_t remaining = m_bufferSize - numFull * m_blockSize;
+  if (remaining > 0)
+  {
+    uint8_t chaining[2 * 256 / 8];
+    KeccakSponge shake(200 - 2 * (m_bits / 8));
+    shake.add(&m_buffer[numFull * m_blockSize], remaining);
+    shake.squeeze(ShakeDomain, chaining, 2 * m_bits / 8);
+    m_sponge.add(chaining, 2 * m_bits / 8);
+    m_numBlocks++;
+  }
+
+  std::string suffix = rightEncode(m_numBlocks) + rightEncode(m_outputBits);
+  m_sponge.add(suffix.c_str(), suffix.size());
+  m_sponge.squeeze(CShakeDomain, buffer, m_outputBits / 8);
+
+  // restore state
+  m_sponge    = oldSponge;
+  m_numBlocks = oldNumBlocks;
+}
+
+
+/// compute hash of a memory block
+std::string ParallelHash::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute hash of a string, excluding final zero
+std::string ParallelHash::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
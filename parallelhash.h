@@ -0,0 +1,85 @@
+// //////////////////////////////////////////////////////////
+// parallelhash.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include "keccakp.h"
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+
+/// compute ParallelHash128 / ParallelHash256 (NIST SP 800-185)
+/** Usage:
+    ParallelHash parallelHash;
+    std::string myHash  = parallelHash("Hello World");     // std::string
+    std::string myHash2 = parallelHash("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    ParallelHash parallelHash(ParallelHash::Bits256, 8192, 512, "my customization");
+    while (more data available)
+      parallelHash.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = parallelHash.getHash();
+
+    Note:
+    Blocks of blockSize bytes are hashed by SHAKE128/256 in parallel,
+    on all threads of the thread pool and four blocks at once per thread (SIMD).
+  */
+class ParallelHash //: public Hash
+{
+public:
+  /// algorithm variants (security strength)
+  enum Bits { Bits128 = 128, Bits256 = 256 };
+
+  /// same as reset(), outputBits = 0 means twice the security strength, pool = NULL means ThreadPool::shared()
+  explicit ParallelHash(Bits bits = Bits128, size_t blockSize = 8192, size_t outputBits = 0,
+                        const std::string& customization = "", ThreadPool* pool = NULL);
+
+  /// compute hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as hex characters
+  std::string getHash();
+  /// return latest hash as bytes (outputBits / 8 bytes)
+  void        getHash(unsigned char* buffer);
+
+  /// restart
+  void reset();
+
+private:
+  /// hash numBlocks blocks in parallel and absorb their chaining values
+  void processBlocks(const uint8_t* data, size_t numBlocks);
+
+  /// variant
+  Bits         m_bits;
+  /// bytes per block ("B")
+  size_t       m_blockSize;
+  /// output length in bits ("L")
+  size_t       m_outputBits;
+  /// cSHAKE prefix: bytepad(encode_string("ParallelHash") || encode_string(S)) || left_encode(B)
+  std::string  m_prefix;
+  /// workers
+  ThreadPool*  m_pool;
+  /// blocks per batch
+  size_t       m_batchBlocks;
+
+  /// outer cSHAKE, absorbs the chaining values
+  KeccakSponge m_sponge;
+  /// number of blocks absorbed by m_sponge
+  uint64_t     m_numBlocks;
+  /// blocks not processed yet
+  std::vector<uint8_t> m_buffer;
+  /// valid bytes in m_buffer
+  size_t       m_bufferSize;
+};
@@ -201,3 +201,43 @@ std::string SHA1::operator()(const std::string& text)
   add(text.c_str(), text.size());
   return getHash();
 }
+
+
+/// export internal state: number of bytes, hash values and unprocessed bytes (little endian)
+std::string SHA1::getState() const
+{
+  std::string state;
+  uint64_t numBytes = m_numBytes + m_bufferSize;
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(numBytes >> shift);
+  for (int i = 0; i < HashValues; i++)
+    for (int shift = 0; shift < 32; shift += 8)
+      state += char(m_hash[i] >> shift);
+  state.append((const char*) m_buffer, m_bufferSize);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid
+bool SHA1::setState(const std::string& state)
+{
+  const size_t HeaderSize = 8 + 4 * HashValues;
+  if (state.size() < HeaderSize)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  uint64_t numBytes = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    numBytes |= uint64_t(*current++) << shift;
+  if (state.size() != HeaderSize + numBytes % BlockSize)
+    return false;
+
+  for (int i = 0; i < HashValues; i++, current += 4)
+    m_hash[i] = uint32_t(current[0]) | (uint32_t(current[1]) << 8) | (uint32_t(current[2]) << 16) | (uint32_t(current[3]) << 24);
+
+  m_bufferSize = size_t(numBytes % BlockSize);
+  m_numBytes   = numBytes - m_bufferSize;
+  for (size_t i = 0; i < m_bufferSize; i++)
+    m_buffer[i] = current[i];
+  return true;
+}
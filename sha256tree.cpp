@@ -0,0 +1,331 @@
+// //////////////////////////////////////////////////////////
+// sha256tree.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "sha256tree.h"
+#include "sha256.h"
+#include "threadpool.h"
+
+#include <cstring> // memcpy
+
+
+/// local helper functions
+namespace
+{
+  /// domain separation, prepended to each node's data
+  const uint8_t LeafPrefix     = 0x00;
+  const uint8_t InteriorPrefix = 0x01;
+
+  /// SHA256(0x01 + left + right)
+  void hashInterior(const uint8_t left[SHA256Tree::HashBytes], const uint8_t right[SHA256Tree::HashBytes],
+                    uint8_t result[SHA256Tree::HashBytes])
+  {
+    SHA256 sha256;
+    sha256.add(&InteriorPrefix, 1);
+    sha256.add(left,  SHA256Tree::HashBytes);
+    sha256.add(right, SHA256Tree::HashBytes);
+    sha256.getHash(result);
+  }
+}
+
+
+/// same as reset(), pool = NULL means ThreadPool::shared()
+SHA256Tree::SHA256Tree(size_t leafSize, ThreadPool* pool)
+: m_leafSize(leafSize == 0 ? size_t(DefaultLeafSize) : leafSize > MaxLeafSize ? size_t(MaxLeafSize) : leafSize),
+  m_pool(pool != NULL ? pool : &ThreadPool::shared())
+{
+  // a few leaves per thread so that stealing can balance the load, but don't buffer more than 64 MB
+  m_batchLeaves = 4 * m_pool->getNumThreads();
+  if (m_batchLeaves * m_leafSize > 64*1024*1024)
+    m_batchLeaves = 64*1024*1024 / m_leafSize;
+  m_buffer.resize(m_batchLeaves * m_leafSize);
+
+  reset();
+}
+
+
+/// restart
+void SHA256Tree::reset()
+{
+  m_numBytes   = 0;
+  m_bufferSize = 0;
+  m_stack.clear();
+}
+
+
+/// leaf size in bytes
+size_t SHA256Tree::getLeafSize() const
+{
+  return m_leafSize;
+}
+
+
+/// number of bytes processed so far
+uint64_t SHA256Tree::getNumBytes() const
+{
+  return m_numBytes;
+}
+
+
+/// push a subtree and merge all subtrees of equal height
+void SHA256Tree::push(Stack& stack, const Node& node)
+{
+  Node current = node;
+  // works like incrementing a binary counter
+  while (!stack.empty() && stack.back().height == current.height)
+  {
+    hashInterior(stack.back().hash, current.hash, current.hash);
+    current.height++;
+    stack.pop_back();
+  }
+  stack.push_back(current);
+}
+
+
+/// hash numLeaves consecutive leaves in parallel (last leaf has lastLeafSize bytes) and merge them into stack
+void SHA256Tree::processLeaves(const uint8_t* data, size_t numLeaves, size_t lastLeafSize, Stack& stack) const
+{
+  std::vector<Node> leaves(numLeaves);
+
+  size_t leafSize = m_leafSize;
+  m_pool->run(numLeaves, [&](size_t i)
+  {
+    SHA256 sha256;
+    sha256.add(&LeafPrefix, 1);
+    sha256.add(data + i * leafSize, i + 1 == numLeaves ? lastLeafSize : leafSize);
+    sha256.getHash(leaves[i].hash);
+    leaves[i].height = 0;
+  });
+
+  // merging is cheap and must happen in order
+  for (size_t i = 0; i < numLeaves; i++)
+    push(stack, leaves[i]);
+}
+
+
+/// add arbitrary number of bytes
+void SHA256Tree::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+  m_numBytes += numBytes;
+
+  size_t batchBytes = m_buffer.size();
+
+  // fill buffer
+  if (m_bufferSize > 0)
+  {
+    size_t copy = batchBytes - m_bufferSize;
+    if (copy > numBytes)
+      copy = numBytes;
+    memcpy(&m_buffer[m_bufferSize], current, copy);
+    m_bufferSize += copy;
+    current      += copy;
+    numBytes     -= copy;
+
+    // full buffer
+    if (m_bufferSize == batchBytes)
+    {
+      processLeaves(&m_buffer[0], m_batchLeaves, m_leafSize, m_stack);
+      m_bufferSize = 0;
+    }
+  }
+
+  // process full batches without copying them
+  while (numBytes >= batchBytes)
+  {
+    processLeaves(current, m_batchLeaves, m_leafSize, m_stack);
+    current  += batchBytes;
+    numBytes -= batchBytes;
+  }
+
+  // keep remaining bytes in buffer
+  if (numBytes > 0)
+  {
+    memcpy(&m_buffer[m_bufferSize], current, numBytes);
+    m_bufferSize += numBytes;
+  }
+}
+
+
+/// return latest hash as 64 hex characters
+std::string SHA256Tree::getHash()
+{
+  // compute hash (as raw bytes)
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * HashBytes);
+  for (int i = 0; i < HashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes
+void SHA256Tree::getHash(unsigned char buffer[SHA256Tree::HashBytes])
+{
+  // empty input
+  if (m_numBytes == 0)
+  {
+    SHA256 sha256;
+    sha256.getHash(buffer);
+    return;
+  }
+
+  // work on a copy, so that more data can be added later
+  Stack stack = m_stack;
+
+  // hash buffered leaves
+  if (m_bufferSize > 0)
+  {
+    size_t numLeaves = (m_bufferSize + m_leafSize - 1) / m_leafSize;
+    processLeaves(&m_buffer[0], numLeaves, m_bufferSize - (numLeaves - 1) * m_leafSize, stack);
+  }
+
+  // merge subtrees from right to left, the smallest subtree is always the right child
+  Node root = stack.back();
+  for (size_t i = stack.size() - 1; i > 0; i--)
+    hashInterior(stack[i - 1].hash, root.hash, root.hash);
+
+  memcpy(buffer, root.hash, HashBytes);
+}
+
+
+/// subtrees of all complete leaves (including buffered leaves), returns number of bytes of a partial leaf
+size_t SHA256Tree::getCompleteLeaves(Stack& stack) const
+{
+  stack = m_stack;
+  size_t numLeaves = m_bufferSize / m_leafSize;
+  if (numLeaves > 0)
+    processLeaves(&m_buffer[0], numLeaves, m_leafSize, stack);
+  return m_bufferSize - numLeaves * m_leafSize;
+}
+
+
+/// export internal state (complete subtrees and the bytes of a partial leaf)
+std::string SHA256Tree::getState() const
+{
+  Stack  stack;
+  size_t partial = getCompleteLeaves(stack);
+
+  // leaf size, number of bytes, number of subtrees (little endian), subtrees (height + hash), partial leaf
+  std::string state;
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(uint64_t(m_leafSize) >> shift);
+  for (int shift = 0; shift < 64; shift += 8)
+    state += char(m_numBytes >> shift);
+  state += char(stack.size());
+  for (size_t i = 0; i < stack.size(); i++)
+  {
+    state += char(stack[i].height);
+    state.append((const char*) stack[i].hash, HashBytes);
+  }
+  state.append((const char*) &m_buffer[m_bufferSize - partial], partial);
+  return state;
+}
+
+
+/// import internal state created by getState(), returns false if invalid or a different leaf size
+bool SHA256Tree::setState(const std::string& state)
+{
+  if (state.size() < 8 + 8 + 1)
+    return false;
+
+  const uint8_t* current = (const uint8_t*) state.data();
+  uint64_t leafSize = 0, numBytes = 0;
+  for (int shift = 0; shift < 64; shift += 8)
+    leafSize |= uint64_t(*current++) << shift;
+  for (int shift = 0; shift < 64; shift += 8)
+    numBytes |= uint64_t(*current++) << shift;
+  size_t numNodes = *current++;
+
+  uint64_t partial = numBytes % m_leafSize;
+  if (leafSize != m_leafSize || state.size() != 8 + 8 + 1 + numNodes * (1 + HashBytes) + partial)
+    return false;
+
+  // heights must be strictly decreasing and cover all complete leaves
+  Stack    stack(numNodes);
+  uint64_t numLeaves = 0;
+  for (size_t i = 0; i < numNodes; i++)
+  {
+    stack[i].height = *current++;
+    memcpy(stack[i].hash, current, HashBytes);
+    current += HashBytes;
+    if (stack[i].height >= 64 || (i > 0 && stack[i].height >= stack[i - 1].height))
+      return false;
+    numLeaves += uint64_t(1) << stack[i].height;
+  }
+  if (numLeaves != numBytes / m_leafSize)
+    return false;
+
+  m_stack      = stack;
+  m_numBytes   = numBytes;
+  m_bufferSize = size_t(partial);
+  memcpy(&m_buffer[0], current, m_bufferSize);
+  return true;
+}
+
+
+/// append another SHA256Tree's data as if it was added to this object, too
+bool SHA256Tree::combine(const SHA256Tree& other)
+{
+  if (other.m_numBytes == 0)
+    return true;
+  if (other.m_leafSize != m_leafSize || m_numBytes % m_leafSize != 0)
+    return false;
+
+  Stack  stack;
+  size_t partial = other.getCompleteLeaves(stack);
+
+  // each subtree must start at a multiple of its size, else it wouldn't be a subtree of the combined tree
+  uint64_t position = m_numBytes / m_leafSize;
+  for (size_t i = 0; i < stack.size(); i++)
+  {
+    uint64_t size = uint64_t(1) << stack[i].height;
+    if (position % size != 0)
+      return false;
+    position += size;
+  }
+
+  // process own buffered leaves, all of them are complete
+  if (m_bufferSize > 0)
+  {
+    processLeaves(&m_buffer[0], m_bufferSize / m_leafSize, m_leafSize, m_stack);
+    m_bufferSize = 0;
+  }
+
+  for (size_t i = 0; i < stack.size(); i++)
+    push(m_stack, stack[i]);
+
+  memcpy(&m_buffer[0], &other.m_buffer[other.m_bufferSize - partial], partial);
+  m_bufferSize = partial;
+  m_numBytes  += other.m_numBytes;
+  return true;
+}
+
+
+/// compute tree hash of a memory block
+std::string SHA256Tree::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute tree hash of a string, excluding final zero
+std::string SHA256Tree::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
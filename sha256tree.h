@@ -0,0 +1,128 @@
+// //////////////////////////////////////////////////////////
+// sha256tree.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+#include <vector>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+class ThreadPool;
+
+
+/// compute a SHA256 Merkle tree hash, leaves are hashed in parallel
+/** Usage:
+    SHA256Tree sha256tree;                   // 64 KB leaves, shared thread pool
+    std::string myHash  = sha256tree("Hello World");
+    std::string myHash2 = sha256tree("How are you", 11);
+
+    // or in a streaming fashion:
+
+    SHA256Tree sha256tree(1024*1024);        // 1 MB leaves
+    while (more data available)
+      sha256tree.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = sha256tree.getHash();
+
+    // or hash ranges independently (e.g. on different machines) and merge them:
+    SHA256Tree first, second;
+    first .add(pointer to first  part, 2^n leaves, at least as many as second);
+    second.add(pointer to second part, number of bytes);
+    first.combine(second);  // same as if both parts were added to first
+
+    Note:
+    The input is split into leaves of leafSize bytes (the last one may be shorter).
+    Nodes are domain-separated like RFC 6962 (Certificate Transparency):
+    - leaf     = SHA256(0x00 + leaf data)
+    - interior = SHA256(0x01 + left child + right child)
+    - a tree with n leaves is split into a perfect left subtree with the largest
+      power of two less than n leaves and the remaining leaves on the right side
+    - empty input => SHA256("")
+    The result depends on the leaf size, it is NOT identical to plain SHA256.
+    Only a few leaves are buffered and a stack of O(log n) subtree hashes is kept.
+  */
+class SHA256Tree //: public Hash
+{
+public:
+  /// hash is 32 bytes long, default leaves are 64 KB, at most 16 MB
+  enum { HashBytes = 32, DefaultLeafSize = 64*1024, MaxLeafSize = 16*1024*1024 };
+
+  /// same as reset(), pool = NULL means ThreadPool::shared(), leafSize is clamped to 1 ... MaxLeafSize (0 = default)
+  explicit SHA256Tree(size_t leafSize = DefaultLeafSize, ThreadPool* pool = NULL);
+
+  /// compute tree hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute tree hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 64 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+  /// leaf size in bytes
+  size_t getLeafSize() const;
+  /// number of bytes processed so far
+  uint64_t getNumBytes() const;
+
+  /// export internal state (complete subtrees and the bytes of a partial leaf)
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid or a different leaf size
+  bool        setState(const std::string& state);
+
+  /// append another SHA256Tree's data as if it was added to this object, too
+  /** Requires the same leaf size. This object must contain only complete leaves and
+      other's subtrees must be aligned to their size in the combined tree, e.g. all parts except
+      the last one contain the same power of two leaves. Returns false otherwise. */
+  bool combine(const SHA256Tree& other);
+
+private:
+  /// root of a perfect subtree
+  struct Node
+  {
+    unsigned int height;
+    uint8_t      hash[HashBytes];
+  };
+  typedef std::vector<Node> Stack;
+
+  /// hash numLeaves consecutive leaves in parallel (last leaf has lastLeafSize bytes) and merge them into stack
+  void processLeaves(const uint8_t* data, size_t numLeaves, size_t lastLeafSize, Stack& stack) const;
+  /// push a subtree and merge all subtrees of equal height
+  static void push(Stack& stack, const Node& node);
+  /// subtrees of all complete leaves (including buffered leaves), returns number of bytes of a partial leaf
+  size_t getCompleteLeaves(Stack& stack) const;
+
+  /// bytes per leaf
+  size_t      m_leafSize;
+  /// number of leaves hashed in parallel
+  size_t      m_batchLeaves;
+  /// workers
+  ThreadPool* m_pool;
+
+  /// size of processed data in bytes
+  uint64_t    m_numBytes;
+  /// roots of all complete subtrees, heights are strictly decreasing
+  Stack       m_stack;
+  /// up to m_batchLeaves leaves not processed yet
+  std::vector<uint8_t> m_buffer;
+  /// valid bytes in m_buffer
+  size_t      m_bufferSize;
+};
@@ -7,18 +7,9 @@
 #pragma once
 
 //#include "hash.h"
+#include "keccakp.h"
 #include <string>
 
-// define fixed size integer types
-#ifdef _MSC_VER
-// Windows
-typedef unsigned __int8  uint8_t;
-typedef unsigned __int64 uint64_t;
-#else
-// GCC
-#include <stdint.h>
-#endif
-
 
 /// compute SHA3 hash
 /** Usage:
@@ -52,30 +43,74 @@ public:
 
   /// return latest hash as hex characters
   std::string getHash();
+  /// return latest hash as bytes (bits / 8 bytes)
+  void        getHash(unsigned char* buffer);
 
   /// restart
   void reset();
 
+  /// export internal state, e.g. to continue hashing later in another process
+  std::string getState() const;
+  /// import internal state created by getState(), returns false if invalid
+  bool        setState(const std::string& state);
+
 private:
-  /// process a full block
-  void processBlock(const void* data);
-  /// process everything left in the internal buffer
-  void processBuffer();
-
-  /// 1600 bits, stored as 25x64 bit, BlockSize is no more than 1152 bits (Keccak224)
-  enum { StateSize    = 1600 / (8 * 8),
-         MaxBlockSize =  200 - 2 * (224 / 8) };
-
-  /// hash
-  uint64_t m_hash[StateSize];
-  /// size of processed data in bytes
-  uint64_t m_numBytes;
-  /// block size (less or equal to MaxBlockSize)
-  size_t   m_blockSize;
-  /// valid bytes in m_buffer
-  size_t   m_bufferSize;
-  /// bytes not processed yet
-  uint8_t  m_buffer[MaxBlockSize];
+  /// Keccak-f[1600] sponge, block size depends on variant
+  KeccakSponge m_sponge;
   /// variant
-  Bits     m_bits;
+  Bits         m_bits;
+};
+
+
+/// compute TurboSHAKE128 / TurboSHAKE256, based on Keccak-p[1600] with 12 instead of 24 rounds (RFC 9861)
+/** Usage:
+    TurboSHAKE turboShake;
+    std::string myHash  = turboShake("Hello World");     // std::string
+    std::string myHash2 = turboShake("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    TurboSHAKE turboShake(TurboSHAKE::Bits256, 64);       // 64 bytes output
+    while (more data available)
+      turboShake.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = turboShake.getHash();
+
+    Note:
+    TurboSHAKE is an extendable-output function, its output is NOT compatible to SHA3/SHAKE.
+    The domain separation byte must be between 0x01 and 0x7F.
+  */
+class TurboSHAKE //: public Hash
+{
+public:
+  /// algorithm variants (security strength)
+  enum Bits { Bits128 = 128, Bits256 = 256 };
+  /// 12 rounds, default domain separation byte
+  enum { Rounds = 12, DefaultDomain = 0x1F };
+
+  /// same as reset(), hashBytes = 0 means twice the security strength
+  explicit TurboSHAKE(Bits bits = Bits128, size_t hashBytes = 0, uint8_t domain = DefaultDomain);
+
+  /// compute hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as hex characters
+  std::string getHash();
+  /// return latest hash as bytes (hashBytes bytes)
+  void        getHash(unsigned char* buffer);
+
+  /// restart
+  void reset();
+
+private:
+  /// Keccak-p[1600, 12] sponge
+  KeccakSponge m_sponge;
+  /// output length
+  size_t       m_hashBytes;
+  /// domain separation byte
+  uint8_t      m_domain;
 };
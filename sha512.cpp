@@ -0,0 +1,226 @@
+// //////////////////////////////////////////////////////////
+// sha512.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "sha512.h"
+
+
+/// initial hash values of all variants
+namespace
+{
+  // according to FIPS 180-4
+  // "the first sixty-four bits of the fractional parts of the square roots of the first eight prime numbers"
+  const uint64_t Sha512Seed[8] =
+  {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+  };
+
+  // "the first sixty-four bits of the fractional parts of the square roots of the ninth through sixteenth prime numbers"
+  const uint64_t Sha384Seed[8] =
+  {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+  };
+
+  // generated by the SHA512/t IV generation function (FIPS 180-4, section 5.3.6)
+  const uint64_t Sha512_256Seed[8] =
+  {
+    0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+    0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+  };
+}
+
+
+/// same as reset()
+SHA512::SHA512()
+: m_initialHash(Sha512Seed),
+  m_hashBytes(HashBytes)
+{
+  reset();
+}
+
+
+/// used by SHA384 and SHA512_256
+SHA512::SHA512(const uint64_t initialHash[8], size_t hashBytes)
+: m_initialHash(initialHash),
+  m_hashBytes(hashBytes)
+{
+  reset();
+}
+
+
+/// same as reset()
+SHA384::SHA384()
+: SHA512(Sha384Seed, HashBytes)
+{
+}
+
+
+/// same as reset()
+SHA512_256::SHA512_256()
+: SHA512(Sha512_256Seed, HashBytes)
+{
+}
+
+
+/// restart
+void SHA512::reset()
+{
+  m_numBytes   = 0;
+  m_bufferSize = 0;
+
+  for (int i = 0; i < HashValues; i++)
+    m_hash[i] = m_initialHash[i];
+}
+
+
+/// add arbitrary number of bytes
+void SHA512::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  if (m_bufferSize > 0)
+  {
+    while (numBytes > 0 && m_bufferSize < BlockSize)
+    {
+      m_buffer[m_bufferSize++] = *current++;
+      numBytes--;
+    }
+  }
+
+  // full buffer
+  if (m_bufferSize == BlockSize)
+  {
+    sha512_compress(m_buffer, m_hash);
+    m_numBytes  += BlockSize;
+    m_bufferSize = 0;
+  }
+
+  // no more data ?
+  if (numBytes == 0)
+    return;
+
+  // process full blocks
+  while (numBytes >= BlockSize)
+  {
+    sha512_compress(current, m_hash);
+    current    += BlockSize;
+    m_numBytes += BlockSize;
+    numBytes   -= BlockSize;
+  }
+
+  // keep remaining bytes in buffer
+  while (numBytes > 0 && m_bufferSize < BlockSize)
+  {
+    m_buffer[m_bufferSize++] = *current++;
+    numBytes--;
+  }
+}
+
+
+/// process final block, less than 128 bytes
+void SHA512::processBuffer()
+{
+  // the input bytes are considered as bits strings, where the first bit is the most significant bit of the byte
+
+  // - append "1" bit to message
+  // - append "0" bits until message length in bit mod 1024 is 896
+  // - append length as 128 bit integer
+
+  // only needed if additional data flows over into a second block
+  unsigned char extra[BlockSize];
+
+  // append a "1" bit, 128 => binary 10000000
+  m_buffer[m_bufferSize] = 128;
+
+  // length needs 16 bytes, won't fit into the current block if more than 111 bytes are used
+  bool twoBlocks = m_bufferSize + 1 + 16 > BlockSize;
+
+  size_t i;
+  for (i = m_bufferSize + 1; i < BlockSize; i++)
+    m_buffer[i] = 0;
+  for (i = 0; i < BlockSize; i++)
+    extra[i] = 0;
+
+  // add message length in bits as 128 bit number (upper 64 bits are always zero, except for the 3 bits shifted out)
+  uint64_t msgBytes = m_numBytes + m_bufferSize;
+  unsigned char* addLength = (twoBlocks ? extra : m_buffer) + BlockSize - 16;
+  uint64_t high = msgBytes >> 61;
+  uint64_t low  = msgBytes << 3;
+
+  // must be big endian
+  for (i = 0; i < 8; i++)
+  {
+    addLength[    i] = (unsigned char)((high >> (56 - 8*i)) & 0xFF);
+    addLength[8 + i] = (unsigned char)((low  >> (56 - 8*i)) & 0xFF);
+  }
+
+  // process blocks
+  sha512_compress(m_buffer, m_hash);
+  // flowed over into a second block ?
+  if (twoBlocks)
+    sha512_compress(extra, m_hash);
+}
+
+
+/// return latest hash as hex characters
+std::string SHA512::getHash()
+{
+  // compute hash (as raw bytes)
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * m_hashBytes);
+  for (size_t i = 0; i < m_hashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes (only the first 48 / 32 bytes are written by SHA384 / SHA512_256)
+void SHA512::getHash(unsigned char buffer[SHA512::HashBytes])
+{
+  // save old hash if buffer is partially filled
+  uint64_t oldHash[HashValues];
+  for (int i = 0; i < HashValues; i++)
+    oldHash[i] = m_hash[i];
+
+  // process remaining bytes
+  processBuffer();
+
+  // big endian
+  for (size_t i = 0; i < m_hashBytes; i++)
+    buffer[i] = (unsigned char)((m_hash[i / 8] >> (56 - 8 * (i % 8))) & 0xFF);
+
+  // restore old hash
+  for (int i = 0; i < HashValues; i++)
+    m_hash[i] = oldHash[i];
+}
+
+
+/// compute SHA512 of a memory block
+std::string SHA512::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute SHA512 of a string, excluding final zero
+std::string SHA512::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
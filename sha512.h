@@ -0,0 +1,116 @@
+// //////////////////////////////////////////////////////////
+// sha512.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+extern "C" void sha512_compress(const uint8_t[128], uint64_t[8]);
+
+
+/// compute SHA512 hash
+/** Usage:
+    SHA512 sha512;
+    std::string myHash  = sha512("Hello World");     // std::string
+    std::string myHash2 = sha512("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    SHA512 sha512;
+    while (more data available)
+      sha512.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = sha512.getHash();
+
+    Note:
+    SHA384 and SHA512/256 (classes SHA384 and SHA512_256) share the same code,
+    they only differ in their initial hash values and truncate the result.
+    On 64 bit CPUs SHA512/256 is usually faster than SHA256.
+  */
+class SHA512 //: public Hash
+{
+public:
+  /// split into 128 byte blocks (=> 1024 bits), hash is 64 bytes long
+  enum { BlockSize = 1024 / 8, HashBytes = 64 };
+
+  /// same as reset()
+  SHA512();
+
+  /// compute SHA512 of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute SHA512 of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as hex characters
+  std::string getHash();
+  /// return latest hash as bytes (only the first 48 / 32 bytes are written by SHA384 / SHA512_256)
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+protected:
+  /// used by SHA384 and SHA512_256
+  SHA512(const uint64_t initialHash[8], size_t hashBytes);
+
+private:
+  /// process everything left in the internal buffer
+  void processBuffer();
+
+  /// size of processed data in bytes
+  uint64_t m_numBytes;
+  /// valid bytes in m_buffer
+  size_t   m_bufferSize;
+  /// bytes not processed yet
+  uint8_t  m_buffer[BlockSize];
+
+  enum { HashValues = HashBytes / 8 };
+  /// hash, stored as integers
+  uint64_t m_hash[HashValues];
+
+  /// initial hash, differs for each variant
+  const uint64_t* m_initialHash;
+  /// length of the result in bytes
+  size_t   m_hashBytes;
+};
+
+
+/// compute SHA384 hash (SHA512 with different initial hash, truncated to 384 bits)
+class SHA384 : public SHA512
+{
+public:
+  /// hash is 48 bytes long
+  enum { HashBytes = 48 };
+
+  /// same as reset()
+  SHA384();
+};
+
+
+/// compute SHA512/256 hash (SHA512 with different initial hash, truncated to 256 bits)
+class SHA512_256 : public SHA512
+{
+public:
+  /// hash is 32 bytes long
+  enum { HashBytes = 32 };
+
+  /// same as reset()
+  SHA512_256();
+};
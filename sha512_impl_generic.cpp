@@ -0,0 +1,248 @@
+// //////////////////////////////////////////////////////////
+// sha512_impl_generic.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#include <cstring> // memcpy
+
+
+// AVX2 message schedule needs GCC's / Clang's vector extensions and x86 target attributes
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SHA512_AVX2
+#define SHA512_INLINE inline __attribute__((always_inline))
+#else
+#define SHA512_INLINE inline
+#endif
+
+
+namespace
+{
+    // "the first sixty-four bits of the fractional parts of the cube roots of the first eighty prime numbers"
+    const uint64_t K[80] =
+    {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+        0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+        0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+        0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+        0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+        0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+        0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+        0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+        0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+        0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+        0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+        0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+        0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+        0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+        0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+        0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+        0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+        0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+        0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+    };
+
+    SHA512_INLINE uint64_t rotate(uint64_t a, uint64_t c)
+    {
+        return (a >> c) | (a << (64 - c));
+    }
+
+    SHA512_INLINE uint64_t swap(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_bswap64(x);
+#endif
+#ifdef MSC_VER
+        return _byteswap_uint64(x);
+#endif
+
+        return  (x >> 56) |
+               ((x >> 40) & 0x000000000000FF00ULL) |
+               ((x >> 24) & 0x0000000000FF0000ULL) |
+               ((x >>  8) & 0x00000000FF000000ULL) |
+               ((x <<  8) & 0x000000FF00000000ULL) |
+               ((x << 24) & 0x0000FF0000000000ULL) |
+               ((x << 40) & 0x00FF000000000000ULL) |
+                (x << 56);
+    }
+
+    /// read 16 big endian words
+    SHA512_INLINE void load(const uint8_t data[128], uint64_t words[16])
+    {
+        memcpy(words, data, 128);
+#if !defined(__BYTE_ORDER) || (__BYTE_ORDER == 0) || (__BYTE_ORDER != __BIG_ENDIAN)
+        for (int i = 0; i < 16; i++)
+            words[i] = swap(words[i]);
+#endif
+    }
+
+    /// one round, the caller rotates the role of the eight variables
+    SHA512_INLINE void round(uint64_t a, uint64_t b, uint64_t c, uint64_t& d,
+                             uint64_t e, uint64_t f, uint64_t g, uint64_t& h, uint64_t wk)
+    {
+        uint64_t x = h + (rotate(e, 14) ^ rotate(e, 18) ^ rotate(e, 41)) + (g ^ (e & (f ^ g))) + wk;
+        uint64_t y = (rotate(a, 28) ^ rotate(a, 34) ^ rotate(a, 39)) + ((a & b) | (c & (a | b)));
+        d += x;
+        h  = x + y;
+    }
+
+    /// eight rounds, wk[i] already contains words[i] + K[i]
+    SHA512_INLINE void rounds8(const uint64_t wk[8], uint64_t& a, uint64_t& b, uint64_t& c, uint64_t& d,
+                                                     uint64_t& e, uint64_t& f, uint64_t& g, uint64_t& h)
+    {
+        round(a, b, c, d, e, f, g, h, wk[0]);
+        round(h, a, b, c, d, e, f, g, wk[1]);
+        round(g, h, a, b, c, d, e, f, wk[2]);
+        round(f, g, h, a, b, c, d, e, wk[3]);
+        round(e, f, g, h, a, b, c, d, wk[4]);
+        round(d, e, f, g, h, a, b, c, wk[5]);
+        round(c, d, e, f, g, h, a, b, wk[6]);
+        round(b, c, d, e, f, g, h, a, wk[7]);
+    }
+
+    /// process 128 bytes, plain C++
+    void compressGeneric(const uint8_t data[128], uint64_t hash[8])
+    {
+        uint64_t words[80];
+        load(data, words);
+
+        // extend to 80 words
+        for (int i = 16; i < 80; i++)
+            words[i] = words[i - 16] +
+                (rotate(words[i - 15],  1) ^ rotate(words[i - 15],  8) ^ (words[i - 15] >> 7)) +
+                words[i -  7] +
+                (rotate(words[i -  2], 19) ^ rotate(words[i -  2], 61) ^ (words[i -  2] >> 6));
+
+        uint64_t wk[80];
+        for (int i = 0; i < 80; i++)
+            wk[i] = words[i] + K[i];
+
+        uint64_t a = hash[0], b = hash[1], c = hash[2], d = hash[3];
+        uint64_t e = hash[4], f = hash[5], g = hash[6], h = hash[7];
+        for (int i = 0; i < 80; i += 8)
+            rounds8(wk + i, a, b, c, d, e, f, g, h);
+
+        hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+        hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+    }
+
+#ifdef SHA512_AVX2
+    /// 4x 64 bit
+    typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+
+    __attribute__((target("avx2")))
+    SHA512_INLINE Lanes4 loadLanes(const uint64_t* x)
+    {
+        Lanes4 result;
+        memcpy(&result, x, sizeof(result));
+        return result;
+    }
+
+    __attribute__((target("avx2")))
+    SHA512_INLINE Lanes4 rotate(Lanes4 a, int c)
+    {
+        return (a >> c) | (a << (64 - c));
+    }
+
+    __attribute__((target("avx2")))
+    SHA512_INLINE Lanes4 sigma0(Lanes4 x)
+    {
+        return rotate(x,  1) ^ rotate(x,  8) ^ (x >> 7);
+    }
+
+    __attribute__((target("avx2")))
+    SHA512_INLINE Lanes4 sigma1(Lanes4 x)
+    {
+        return rotate(x, 19) ^ rotate(x, 61) ^ (x >> 6);
+    }
+
+    /// compute words[i..i+3] and add round constants
+    __attribute__((target("avx2")))
+    SHA512_INLINE void extend4(uint64_t words[80], uint64_t wk[80], int i)
+    {
+        Lanes4 next = loadLanes(words + i - 16) + sigma0(loadLanes(words + i - 15)) + loadLanes(words + i - 7);
+
+        // words[i..i+3] depend on words[i-2..i+1], so the upper two lanes have to wait for the lower two
+        Lanes4 low = { words[i - 2], words[i - 1], 0, 0 };
+        next += sigma1(low);
+        Lanes4 high = { 0, 0, next[0], next[1] };
+        next += sigma1(high);
+
+        memcpy(words + i, &next, sizeof(next));
+        next += loadLanes(K + i);
+        memcpy(wk    + i, &next, sizeof(next));
+    }
+
+    /// process 128 bytes, message schedule is computed for 4 words at once
+    /// and interleaved with the rounds so that the CPU can run both in parallel
+    __attribute__((target("avx2")))
+    void compressAvx2(const uint8_t data[128], uint64_t hash[8])
+    {
+        uint64_t words[80];
+        load(data, words);
+
+        uint64_t wk[80];
+        for (int i = 0; i < 16; i += 4)
+        {
+            Lanes4 sum = loadLanes(words + i) + loadLanes(K + i);
+            memcpy(wk + i, &sum, sizeof(sum));
+        }
+
+        uint64_t a = hash[0], b = hash[1], c = hash[2], d = hash[3];
+        uint64_t e = hash[4], f = hash[5], g = hash[6], h = hash[7];
+        for (int i = 0; i < 80; i += 8)
+        {
+            // extend words while the current rounds are running
+            if (i + 16 < 80)
+            {
+                extend4(words, wk, i + 16);
+                extend4(words, wk, i + 20);
+            }
+            rounds8(wk + i, a, b, c, d, e, f, g, h);
+        }
+
+        hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+        hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+    }
+#endif
+
+    /// signature of all kernels
+    typedef void (*Compress)(const uint8_t data[128], uint64_t hash[8]);
+
+    /// pick fastest kernel supported by the CPU
+    Compress selectKernel()
+    {
+#ifdef SHA512_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return compressAvx2;
+#endif
+        return compressGeneric;
+    }
+}
+
+
+/// process 128 bytes
+extern "C" void sha512_compress(const uint8_t data[128], uint64_t hash[8])
+{
+    // chosen on first use
+    static const Compress kernel = selectKernel();
+    kernel(data, hash);
+}
@@ -1,5 +1,5 @@
 // minimal test case for https://github.com/stbrumme/hash-library/issues/2
-// g++ github-issue2.cpp ../sha*.cpp ../keccak.cpp ../md5.cpp -o github-issue2 && ./github-issue2
+// g++ github-issue2.cpp ../sha*.cpp ../keccak.cpp ../keccakp.cpp ../md5.cpp ../threadpool.cpp -pthread -o github-issue2 && ./github-issue2
 
 #include "../sha1.h"
 #include "../sha256.h"
@@ -5,22 +5,43 @@
 //
 
 // simple test suite for hash-library
-// g++ tests.cpp ../crc32.cpp ../md5.cpp ../sha1.cpp ../sha256.cpp ../sha3.cpp -o tests && ./tests
+// g++ tests.cpp ../crc32.cpp ../crc32c.cpp ../crc64.cpp ../md5.cpp ../sha1.cpp ../sha256.cpp ../sha512.cpp ../sha512_impl_generic.cpp ../sha3.cpp ../keccak.cpp ../keccakp.cpp ../sha256tree.cpp ../threadpool.cpp ../parallelhash.cpp ../kangarootwelve.cpp ../blake3.cpp ../multihash.cpp ../asyncreader.cpp -pthread -o tests && ./tests
 
 #include "../crc32.h"
+#include "../crc32c.h"
+#include "../crc64.h"
+#include "../crc.h"
 #include "../md5.h"
 #include "../sha1.h"
 #include "../sha256.h"
+#include "../sha512.h"
 #include "../sha3.h"
 #include "../keccak.h"
+#include "../sha256tree.h"
+#include "../parallelhash.h"
+#include "../kangarootwelve.h"
+#include "../blake3.h"
+#include "../threadpool.h"
+#include "../multihash.h"
+#ifndef _MSC_VER
+#include "../asyncreader.h"
+#endif
 
 #include "../hmac.h"
 
 #include <string>
 #include <vector>
+#include <algorithm>
 
 #include <iostream>
 
+#ifndef _MSC_VER
+#include <thread>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 struct TestSet
 {
@@ -242,6 +263,27 @@ int main()
   errors += check<SHA256>(abc896bits, "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
   errors += check<SHA256>(million,    "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
 
+  std::cout << "test SHA2/512 ...\n";
+  errors += check<SHA512>(empty,      "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e");
+  errors += check<SHA512>(abc,        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+  errors += check<SHA512>(abc448bits, "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c33596fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445");
+  errors += check<SHA512>(abc896bits, "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909");
+  errors += check<SHA512>(million,    "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b");
+
+  std::cout << "test SHA2/384 ...\n";
+  errors += check<SHA384>(empty,      "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b");
+  errors += check<SHA384>(abc,        "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+  errors += check<SHA384>(abc448bits, "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6b0455a8520bc4e6f5fe95b1fe3c8452b");
+  errors += check<SHA384>(abc896bits, "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039");
+  errors += check<SHA384>(million,    "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b07b8b3dc38ecc4ebae97ddd87f3d8985");
+
+  std::cout << "test SHA2/512-256 ...\n";
+  errors += check<SHA512_256>(empty,      "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a");
+  errors += check<SHA512_256>(abc,        "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23");
+  errors += check<SHA512_256>(abc448bits, "bde8e1f9f19bb9fd3406c90ec6bc47bd36d8ada9f11880dbc8a22a7078b6a461");
+  errors += check<SHA512_256>(abc896bits, "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a");
+  errors += check<SHA512_256>(million,    "9a59a052930187a97038cae692f30708aa6491923ef5194394dc68d56c74fb21");
+
   std::cout << "test SHA3/256 ...\n";
   errors += check<SHA3>(empty,      "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a");
   errors += check<SHA3>(abc,        "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532");
@@ -249,6 +291,572 @@ int main()
   errors += check<SHA3>(abc896bits, "916f6061fe879741ca6469b43971dfdb28b1a32dc36cb3254e812be27aad1d18");
   errors += check<SHA3>(million,    "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1");
 
+  // same as RFC 6962's Merkle Tree Hash when data is split into equally-sized leaves
+  std::cout << "test SHA2/256 tree ...\n";
+  errors += check<SHA256Tree>(empty,   "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  errors += check<SHA256Tree>(abc,     "609f6e36d2405585188d5cfd761f407c7cc46a7d3f314c88270469dde315fcd1");
+  errors += check<SHA256Tree>(million, "c3fa26996cd7eb4e09e725be994cff6963821fcc1ac2d6d37f4c7ca2f1ef792a");
+  SHA256Tree sha256tree(1000);
+  for (size_t i = 0; i < million.size(); i += 777)
+    sha256tree.add(million.c_str() + i, i + 777 <= million.size() ? 777 : million.size() - i);
+  if (sha256tree.getHash() != "8b8e1ca61e8108fd141dc1cf492da2be21b1628cbb165fd80fc48ffa99abdf80")
+  {
+    std::cerr << "SHA2/256 tree with 1000 byte leaves failed" << std::endl;
+    errors++;
+  }
+
+  // samples from https://csrc.nist.gov/projects/cryptographic-standards-and-guidelines/example-values
+  std::cout << "test ParallelHash ...\n";
+  std::vector<unsigned char> parallelInput = hex2bin("000102030405060710111213141516172021222324252627");
+  ParallelHash parallelHash128(ParallelHash::Bits128, 8);
+  if (parallelHash128(&parallelInput[0], parallelInput.size()) != "ba8dc1d1d979331d3f813603c67f72609ab5e44b94a0b8f9af46514454a2b4f5")
+  {
+    std::cerr << "ParallelHash128 failed" << std::endl;
+    errors++;
+  }
+  ParallelHash parallelHash256(ParallelHash::Bits256, 8);
+  if (parallelHash256(&parallelInput[0], parallelInput.size()) != "bc1ef124da34495e948ead207dd9842235da432d2bbc54b4c110e64c451105531b7f2a3e0ce055c02805e7c2de1fb746af97a1dd01f43b824e31b87612410429")
+  {
+    std::cerr << "ParallelHash256 failed" << std::endl;
+    errors++;
+  }
+  // more than four blocks (SIMD) and a partial last block, verified with an independent implementation
+  std::vector<unsigned char> blocks;
+  for (size_t i = 0; i < 9*8192 + 100; i++)
+    blocks.push_back((unsigned char)(i % 251));
+  struct { ParallelHash::Bits bits; size_t blockSize; size_t numBytes; const char* expected; } parallelTests[] =
+  {
+    { ParallelHash::Bits128,    8,    32, "0c8919f63c11a66d471b328be0c7b331a4d44e7667e30ef1105f35425a12308b" },
+    { ParallelHash::Bits128,    8,    37, "7d83a4332da3ed149bc614061c4b438a59368016540115f5293c917eb35362e8" },
+    { ParallelHash::Bits128, 8192, blocks.size(), "73a885d497bda3937848ecc5d968e587043fb753504c7aca7f321aa5d4e97975" },
+    { ParallelHash::Bits256,    8,    32, "79c3ba53c5b3102adb834935797f27f3997a9d8c86ed271586de2a729df5217e"
+                                          "33bc71b86e94b45ac19939bc4f7a3811f85934339d5591d634dcf2f052f91052" },
+    { ParallelHash::Bits256,    8,    37, "be0d5103b2537feebe39ab66c51c6239a14781ef53cc8d64fdfd2ed97beab504"
+                                          "d87a1dd4db8f0156a1a2b5d7fd678b4ae2853ea8ea4189dc70335001e58d595e" },
+    { ParallelHash::Bits256, 8192, blocks.size(), "b4c26cdac42a3545aab00d4c8ad185ef7c806472e3cdcab9308113fe0b2a4a55"
+                                                  "b4431afa0e9da60f01db19adbcbe02d5f9fc74cd506c716e50f607b7f6fc5329" }
+  };
+  for (size_t i = 0; i < sizeof(parallelTests) / sizeof(parallelTests[0]); i++)
+  {
+    ParallelHash parallelHash(parallelTests[i].bits, parallelTests[i].blockSize);
+    if (parallelHash(&blocks[0], parallelTests[i].numBytes) != parallelTests[i].expected)
+    {
+      std::cerr << "ParallelHash" << int(parallelTests[i].bits) << " of " << parallelTests[i].numBytes << " bytes failed" << std::endl;
+      errors++;
+    }
+  }
+
+  // test vectors from RFC 9861, input is a repeating pattern 00 01 02 .. F9 FA
+  std::cout << "test KangarooTwelve ...\n";
+  std::vector<unsigned char> pattern;
+  for (size_t i = 0; i < 17*17*17*17*17*17; i++)
+    pattern.push_back((unsigned char)(i % 251));
+  errors += check<KangarooTwelve>(empty, "1ac2d450fc3b4205d19da7bfca1b37513c0803577ac7167f06fe2ce1f0ef39e5");
+  errors += check<KangarooTwelve>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 17),
+                                  "6bf75fa2239198db4772e36478f8e19b0f371205f6a9a93a273f51df37122888");
+  errors += check<KangarooTwelve>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 17*17*17),
+                                  "cb552e2ec77d9910701d578b457ddf772c12e322e4ee7fe417f92c758f0d59d0");
+  errors += check<KangarooTwelve>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 17*17*17*17),
+                                  "8701045e22205345ff4dda05555cbb5c3af1a771c2b89baef37db43d9998b9fe");
+  errors += check<KangarooTwelve>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 17*17*17*17*17),
+                                  "844d610933b1b9963cbdeb5ae3b6b05cc7cbd67ceedf883eb678a0a8e0371682");
+  errors += check<KangarooTwelve>(pattern, "3c390782a8a4e89fa6367f72feaaf13255c8d95878481d3cd8ce85f58e880af8");
+  // customization string C = ptn(41^n) and message M = n times FF
+  struct { size_t numBytes; size_t customLength; const char* expected; } k12custom[] =
+  {
+    { 0,        1, "fab658db63e94a246188bf7af69a133045f46ee984c56e3c3328caaf1aa1a583" },
+    { 1,       41, "d848c5068ced736f4462159b9867fd4c20b808acc3d5bc48e0b06ba0a3762ec4" },
+    { 3,    41*41, "c389e5009ae57120854c2e8c64670ac01358cf4c1baf89447a724234dc7ced74" },
+    { 7, 41*41*41, "75d2f86a2e644566726b4fbcfc5657b9dbcf070c7b0dca06450ab291d7443bcf" }
+  };
+  for (size_t i = 0; i < sizeof(k12custom) / sizeof(k12custom[0]); i++)
+  {
+    std::string message(k12custom[i].numBytes, char(0xFF));
+    KangarooTwelve k12(KangarooTwelve::DefaultHashBytes, std::string(pattern.begin(), pattern.begin() + k12custom[i].customLength));
+    if (k12(message) != k12custom[i].expected)
+    {
+      std::cerr << "KangarooTwelve with " << k12custom[i].customLength << " bytes customization failed" << std::endl;
+      errors++;
+    }
+  }
+
+  // test vectors from RFC 9861
+  std::cout << "test TurboSHAKE ...\n";
+  errors += check<TurboSHAKE>(empty, "1e415f1c5983aff2169217277d17bb538cd945a397ddec541f1ce41af2c1b74c");
+  errors += check<TurboSHAKE>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 1),
+                              "55cedd6f60af7bb29a4042ae832ef3f58db7299f893ebb9247247d856958daa9");
+  TurboSHAKE turboShake256(TurboSHAKE::Bits256);
+  if (turboShake256(empty) != "367a329dafea871c7802ec67f905ae13c57695dc2c6663c61035f59a18f8e7db"
+                              "11edc0e12e91ea60eb6b32df06dd7f002fbafabb6e13ec1cc20d995547600db0")
+  {
+    std::cerr << "TurboSHAKE256 failed" << std::endl;
+    errors++;
+  }
+
+  // official test vectors from https://github.com/BLAKE3-team/BLAKE3/blob/master/test_vectors/test_vectors.json
+  std::cout << "test BLAKE3 (" << BLAKE3::getImplementation() << ") ...\n";
+  pattern.clear();
+  for (size_t i = 0; i < 102400; i++)
+    pattern.push_back((unsigned char)(i % 251));
+  errors += check<BLAKE3>(empty, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+  errors += check<BLAKE3>(abc,   "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85");
+  errors += check<BLAKE3>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 1024),
+                          "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7");
+  errors += check<BLAKE3>(std::vector<unsigned char>(pattern.begin(), pattern.begin() + 1025),
+                          "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444");
+  errors += check<BLAKE3>(pattern, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085");
+  BLAKE3 blake3threads(&ThreadPool::shared());
+  if (blake3threads(&pattern[0], pattern.size()) != "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085")
+  {
+    std::cerr << "multi-threaded BLAKE3 failed" << std::endl;
+    errors++;
+  }
+
+  // CRC32 of independently hashed chunks, CRC32("1234") = 9be3e0a3, CRC32("56789") = 131da070
+  std::cout << "test CRC32 combine ...\n";
+  if (crc32_combine(0x9be3e0a3, 0x131da070, 5) != 0xcbf43926)
+  {
+    std::cerr << "crc32_combine failed" << std::endl;
+    errors++;
+  }
+  CRC32 crc32whole;
+  std::string crc32expected = crc32whole(&pattern[0], pattern.size());
+  for (size_t split = 0; split <= pattern.size(); split += 10240 - 1)
+  {
+    CRC32 crc32head, crc32tail;
+    crc32head.add(pattern.data(),         split);
+    crc32tail.add(pattern.data() + split, pattern.size() - split);
+    crc32head.combine(crc32tail);
+    if (crc32head.getHash() != crc32expected || crc32head.getNumBytes() != pattern.size())
+    {
+      std::cerr << "CRC32 combine failed, split at " << split << std::endl;
+      errors++;
+    }
+  }
+
+  std::vector<unsigned char> crc32large(5 * 1024 * 1024 + 3);
+  for (size_t i = 0; i < crc32large.size(); i++)
+    crc32large[i] = (unsigned char)(i % 251);
+  CRC32 crc32threads(&ThreadPool::shared());
+  if (crc32threads(crc32large.data(), crc32large.size()) != crc32whole(crc32large.data(), crc32large.size()))
+  {
+    std::cerr << "multi-threaded CRC32 failed" << std::endl;
+    errors++;
+  }
+
+  // "abc" + one million zeros + "abc"
+  std::vector<unsigned char> crc32zeros(3 + 1000000 + 3, 0);
+  crc32zeros[0] = crc32zeros[crc32zeros.size() - 3] = 'a';
+  crc32zeros[1] = crc32zeros[crc32zeros.size() - 2] = 'b';
+  crc32zeros[2] = crc32zeros[crc32zeros.size() - 1] = 'c';
+  CRC32 crc32sparse;
+  crc32sparse.add(abc.c_str(), 3);
+  crc32sparse.addZeros(1000000);
+  crc32sparse.add(abc.c_str(), 3);
+  if (crc32sparse.getHash() != crc32whole(crc32zeros.data(), crc32zeros.size()) || crc32sparse.getNumBytes() != crc32zeros.size())
+  {
+    std::cerr << "CRC32 addZeros failed" << std::endl;
+    errors++;
+  }
+
+  // modify a few bytes of a 16k page
+  std::vector<unsigned char> page(pattern.begin(), pattern.begin() + 16384);
+  CRC32 crc32page;
+  crc32page.add(page.data(), page.size());
+  for (size_t offset = 0; offset + 40 <= page.size(); offset += 4000)
+  {
+    std::vector<unsigned char> oldBytes(page.begin() + offset, page.begin() + offset + 40);
+    for (size_t i = 0; i < 40; i++)
+      page[offset + i] ^= (unsigned char)(i * 13 + offset);
+    crc32page.patch(offset, oldBytes.data(), page.data() + offset, 40);
+    if (crc32page.getHash() != crc32whole(page.data(), page.size()))
+    {
+      std::cerr << "CRC32 patch failed, offset " << offset << std::endl;
+      errors++;
+    }
+  }
+  // bytes beyond the end of the page are ignored
+  std::string crc32patched = crc32page.getHash();
+  crc32page.patch(page.size() - 20, page.data(), page.data() + 40, 40);
+  crc32page.patch(page.size() + 20, page.data(), page.data() + 40, 40);
+  if (crc32page.getHash() != crc32patched)
+  {
+    std::cerr << "CRC32 patch beyond the end failed" << std::endl;
+    errors++;
+  }
+
+  // RFC 3720 (iSCSI), appendix B.4
+  std::cout << "test CRC32C (" << CRC32C::getImplementation() << ") ...\n";
+  errors += check<CRC32C>(empty,                          "00000000");
+  errors += check<CRC32C>(abc,                            "364b3fb7");
+  errors += check<CRC32C>(std::string("123456789"),       "e3069283");
+  errors += check<CRC32C>(std::vector<unsigned char>(32), "8a9136aa");
+  errors += check<CRC32C>(million,                        "436fe240");
+
+  // copy to odd offsets to test alignment, with and without non-temporal stores
+  std::cout << "test copy and CRC32/CRC32C ...\n";
+  unsigned char raw[4];
+  crc32whole(pattern.data(), pattern.size());
+  crc32whole.getHash(raw);
+  uint32_t expectedCrc32  = (raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3];
+  CRC32C crc32c;
+  crc32c(pattern.data(), pattern.size());
+  crc32c.getHash(raw);
+  uint32_t expectedCrc32c = (raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3];
+  for (size_t offset = 0; offset < 9; offset += 3)
+    for (int nonTemporal = 0; nonTemporal <= 1; nonTemporal++)
+    {
+      std::vector<unsigned char> copy(pattern.size() + offset);
+      uint32_t crc = copy_and_crc32(copy.data() + offset, pattern.data(), pattern.size(), 0, nonTemporal != 0);
+      bool same = std::equal(pattern.begin(), pattern.end(), copy.begin() + offset);
+
+      // split into two calls to test previousCrc32c
+      std::vector<unsigned char> copyc(pattern.size() + offset);
+      uint32_t crcc = copy_and_crc32c(copyc.data() + offset, pattern.data(), 1000, 0, nonTemporal != 0);
+      crcc = copy_and_crc32c(copyc.data() + offset + 1000, pattern.data() + 1000, pattern.size() - 1000, crcc, nonTemporal != 0);
+      bool samec = std::equal(pattern.begin(), pattern.end(), copyc.begin() + offset);
+
+      if (!same || !samec || crc != expectedCrc32 || crcc != expectedCrc32c)
+      {
+        std::cerr << "copy and CRC32/CRC32C failed, offset " << offset << std::endl;
+        errors++;
+      }
+    }
+
+  // many small buffers of different size
+  std::cout << "test batched CRC32/CRC32C ...\n";
+  std::vector<const void*> batchData;
+  std::vector<size_t>      batchSize;
+  for (size_t i = 0; i < 300; i++)
+  {
+    batchData.push_back(pattern.data() + i * 7);
+    batchSize.push_back(i % 5 == 0 ? 1500 : i % 70);
+  }
+  std::vector<uint32_t> batchCrc32(batchData.size()), batchCrc32c(batchData.size());
+  crc32_batch (batchData.data(), batchSize.data(), batchData.size(), batchCrc32 .data());
+  crc32c_batch(batchData.data(), batchSize.data(), batchData.size(), batchCrc32c.data());
+  for (size_t i = 0; i < batchData.size(); i++)
+  {
+    crc32whole(batchData[i], batchSize[i]);
+    crc32whole.getHash(raw);
+    bool ok = batchCrc32[i] == uint32_t((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3]);
+    crc32c(batchData[i], batchSize[i]);
+    crc32c.getHash(raw);
+    ok &= batchCrc32c[i] == uint32_t((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3]);
+    if (!ok)
+    {
+      std::cerr << "batched CRC32/CRC32C failed, buffer " << i << std::endl;
+      errors++;
+    }
+  }
+
+  // fixed-size pages, two 512 byte pages are chained to test previousCrc32
+  std::cout << "test CRC32/CRC32C of pages ...\n";
+  struct Page { size_t numBytes; uint32_t crc32, crc32c; };
+  Page pages[] =
+  {
+    { 1024, crc32_page<  512>(pattern.data() + 512, crc32_page<512>(pattern.data())),
+            crc32c_page<  512>(pattern.data() + 512, crc32c_page<512>(pattern.data())) },
+    { 4096, crc32_page< 4096>(pattern.data()), crc32c_page< 4096>(pattern.data()) },
+    { 8192, crc32_page< 8192>(pattern.data()), crc32c_page< 8192>(pattern.data()) },
+    {16384, crc32_page<16384>(pattern.data()), crc32c_page<16384>(pattern.data()) }
+  };
+  for (size_t i = 0; i < sizeof(pages) / sizeof(pages[0]); i++)
+  {
+    crc32whole(pattern.data(), pages[i].numBytes);
+    crc32whole.getHash(raw);
+    bool ok = pages[i].crc32  == uint32_t((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3]);
+    crc32c(pattern.data(), pages[i].numBytes);
+    crc32c.getHash(raw);
+    ok &= pages[i].crc32c == uint32_t((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3]);
+    if (!ok)
+    {
+      std::cerr << "CRC32/CRC32C of pages failed, size " << pages[i].numBytes << std::endl;
+      errors++;
+    }
+  }
+
+  // shifts and XORs only, split into two parts to test previousCrc32
+  std::cout << "test table-free CRC32 ...\n";
+  for (size_t length = 0; length < 1000; length += 3)
+  {
+    uint32_t crc = crc32_tablefree(pattern.data(), length / 2);
+    crc = crc32_tablefree(pattern.data() + length / 2, length - length / 2, crc);
+    crc32whole(pattern.data(), length);
+    crc32whole.getHash(raw);
+    if (crc != uint32_t((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3]))
+    {
+      std::cerr << "table-free CRC32 failed, length " << length << std::endl;
+      errors++;
+    }
+  }
+
+  // CRC-64/XZ and CRC-64/NVME check values
+  std::cout << "test CRC64 (" << CRC64::getImplementation() << ") ...\n";
+  errors += check<CRC64>(empty,                    "0000000000000000");
+  errors += check<CRC64>(abc,                      "2cd8094a1a277627");
+  errors += check<CRC64>(std::string("123456789"), "995dc9bbdf1939fa");
+  errors += check<CRC64>(million,                  "7a0d29398112e1ba");
+  CRC64 crc64nvme(CRC64::Nvme);
+  if (crc64nvme("123456789") != "ae8b14860a799888" || crc64nvme(abc) != "05e5cabb3fc1faeb" ||
+      crc64nvme(million)     != "38b0ef50419e0b4c")
+  {
+    std::cerr << "CRC64 NVMe failed" << std::endl;
+    errors++;
+  }
+
+  // all lengths up to a few folding blocks, byte-wise (table only) vs. one call (folding) vs. two combined halves
+  CRC64 crc64whole;
+  for (size_t length = 0; length < 600; length += 7)
+  {
+    CRC64 crc64bytewise;
+    for (size_t i = 0; i < length; i++)
+      crc64bytewise.add(pattern.data() + i, 1);
+    CRC64 crc64first, crc64second;
+    crc64first .add(pattern.data(), length / 3);
+    crc64second.add(pattern.data() + length / 3, length - length / 3);
+    crc64first.combine(crc64second);
+    std::string crc64expected = crc64whole(pattern.data(), length);
+    if (crc64bytewise.getHash() != crc64expected || crc64first.getHash() != crc64expected)
+    {
+      std::cerr << "CRC64 failed, length " << length << std::endl;
+      errors++;
+    }
+  }
+
+  // generic CRC engine, check values from the "Catalogue of parametrised CRC algorithms"
+  std::cout << "test CRC-32/BZIP2, CRC-32K, CRC-16 (" << CRC16::getImplementation() << ") ...\n";
+  errors += check<CRC32_BZIP2>(abc,                      "648cbb73");
+  errors += check<CRC32_BZIP2>(std::string("123456789"), "fc891918");
+  errors += check<CRC32_BZIP2>(million,                  "97bedc38");
+  errors += check<CRC32K>     (abc,                      "ba2322ac");
+  errors += check<CRC32K>     (std::string("123456789"), "2d3dd0ae");
+  errors += check<CRC32K>     (million,                  "913e1169");
+  errors += check<CRC16>      (abc,                      "9738");
+  errors += check<CRC16>      (std::string("123456789"), "bb3d");
+  errors += check<CRC16>      (million,                  "ed59");
+  errors += check<CRC16_CCITT>(empty,                    "ffff");
+  errors += check<CRC16_CCITT>(abc,                      "514a");
+  errors += check<CRC16_CCITT>(std::string("123456789"), "29b1");
+  errors += check<CRC16_CCITT>(million,                  "5924");
+  errors += check<CRC<24, 0x864CFB, false, 0xB704CE, 0> >(std::string("123456789"), "21cf02");
+  // reflected with an asymmetric Init (CRC-16/RIELLO, CRC-24/BLE)
+  errors += check<CRC<16, 0x1021,   true,  0xB2AA,   0> >(std::string("123456789"), "63d0");
+  errors += check<CRC<24, 0x00065B, true,  0x555555, 0> >(std::string("123456789"), "c25a56");
+
+  // same parameters as CRC32 / CRC64: must produce identical results for all lengths (folding and table)
+  typedef CRC<32, 0x04C11DB7,            true,  0xFFFFFFFF, 0xFFFFFFFF> GenericCrc32;
+  typedef CRC<64, 0x42F0E1EBA9EA3693ULL, true,  ~0ULL,      ~0ULL>      GenericCrc64;
+  GenericCrc32 genericCrc32;
+  GenericCrc64 genericCrc64;
+  CRC32_BZIP2  bzip2;
+  for (size_t length = 0; length < 600; length += 5)
+  {
+    CRC32_BZIP2 bzip2bytewise;
+    for (size_t i = 0; i < length; i++)
+      bzip2bytewise.add(pattern.data() + i, 1);
+    if (genericCrc32(pattern.data(), length) != crc32whole(pattern.data(), length) ||
+        genericCrc64(pattern.data(), length) != crc64whole(pattern.data(), length) ||
+        bzip2       (pattern.data(), length) != bzip2bytewise.getHash())
+    {
+      std::cerr << "generic CRC failed, length " << length << std::endl;
+      errors++;
+    }
+  }
+
+  // several hashes fed tile by tile, odd chunk sizes cross tile boundaries
+  std::cout << "test MultiHash ...\n";
+  {
+    CRC32  multiCrc32;
+    MD5    multiMd5;
+    SHA1   multiSha1;
+    SHA256 multiSha256;
+    SHA512 multiSha512;
+    SHA3   multiSha3;
+    MultiHash multi(1000);
+    multi.attach(multiCrc32);
+    multi.attach(multiMd5);
+    multi.attach(multiSha1);
+    multi.attach(multiSha256);
+    multi.attach(multiSha512);
+    multi.attach(multiSha3);
+    for (size_t step = 1; step < 3000; step += 997)
+    {
+      multi.reset();
+      for (size_t i = 0; i < million.size(); i += step)
+        multi.add(million.data() + i, std::min(step, million.size() - i));
+      if (multiCrc32 .getHash() != "dc25bfbc" ||
+          multiMd5   .getHash() != "7707d6ae4e027c70eea2a935c2296f21" ||
+          multiSha1  .getHash() != "34aa973cd4c4daa4f61eeb2bdbad27316534016f" ||
+          multiSha256.getHash() != "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" ||
+          multiSha512.getHash() != SHA512()(million) ||
+          multiSha3  .getHash() != "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1")
+      {
+        std::cerr << "MultiHash failed, step " << step << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  // export state after an odd number of bytes, import into a fresh object and continue
+  std::cout << "test getState/setState ...\n";
+  {
+    size_t split = 123457;
+    CRC32  firstCrc32,  secondCrc32;
+    CRC64  firstCrc64,  secondCrc64;
+    MD5    firstMd5,    secondMd5;
+    SHA1   firstSha1,   secondSha1;
+    SHA256 firstSha256, secondSha256;
+    Keccak firstKeccak, secondKeccak;
+    SHA3   firstSha3,   secondSha3;
+    firstCrc32 .add(million.data(), split);
+    firstCrc64 .add(million.data(), split);
+    firstMd5   .add(million.data(), split);
+    firstSha1  .add(million.data(), split);
+    firstSha256.add(million.data(), split);
+    firstKeccak.add(million.data(), split);
+    firstSha3  .add(million.data(), split);
+    if (!secondCrc32 .setState(firstCrc32 .getState()) ||
+        !secondCrc64 .setState(firstCrc64 .getState()) ||
+        !secondMd5   .setState(firstMd5   .getState()) ||
+        !secondSha1  .setState(firstSha1  .getState()) ||
+        !secondSha256.setState(firstSha256.getState()) ||
+        !secondKeccak.setState(firstKeccak.getState()) ||
+        !secondSha3  .setState(firstSha3  .getState()) ||
+        secondSha256.setState(firstSha1.getState()))
+    {
+      std::cerr << "setState failed" << std::endl;
+      errors++;
+    }
+    secondCrc32 .add(million.data() + split, million.size() - split);
+    secondCrc64 .add(million.data() + split, million.size() - split);
+    secondMd5   .add(million.data() + split, million.size() - split);
+    secondSha1  .add(million.data() + split, million.size() - split);
+    secondSha256.add(million.data() + split, million.size() - split);
+    secondKeccak.add(million.data() + split, million.size() - split);
+    secondSha3  .add(million.data() + split, million.size() - split);
+    if (secondCrc32 .getHash() != "dc25bfbc" ||
+        secondCrc64 .getHash() != CRC64()(million) ||
+        secondMd5   .getHash() != "7707d6ae4e027c70eea2a935c2296f21" ||
+        secondSha1  .getHash() != "34aa973cd4c4daa4f61eeb2bdbad27316534016f" ||
+        secondSha256.getHash() != "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" ||
+        secondKeccak.getHash() != Keccak()(million) ||
+        secondSha3  .getHash() != "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1")
+    {
+      std::cerr << "getState/setState failed" << std::endl;
+      errors++;
+    }
+  }
+
+  // merge ranges of a Merkle tree which were hashed independently
+  std::cout << "test SHA256Tree::combine ...\n";
+  {
+    SHA256Tree full(1024), first(1024), second(1024), imported(1024), misaligned(1024);
+    full  .add(million.data(), million.size());
+    first .add(million.data(), 512 * 1024);
+    second.add(million.data() + 512 * 1024, million.size() - 512 * 1024);
+    misaligned.add(million.data(), 3 * 1024);
+    if (!imported.setState(second.getState()) || imported.getNumBytes() != million.size() - 512 * 1024 ||
+        !first.combine(imported) || first.getHash() != full.getHash() || first.getNumBytes() != million.size() ||
+        misaligned.combine(second) || SHA256Tree(4096).setState(second.getState()))
+    {
+      std::cerr << "SHA256Tree::combine failed" << std::endl;
+      errors++;
+    }
+  }
+
+#ifndef _MSC_VER
+  // read a file and a pipe through AsyncReader, with io_uring (if available) and the background thread
+  {
+    const size_t BufferSize = 8192;
+    const size_t NumBuffers = 4;
+    // more than all buffers, deliberately not a multiple of the buffer size
+    std::string random(3 * NumBuffers * BufferSize + 1234, 0);
+    for (size_t i = 0; i < random.size(); i++)
+      random[i] = char(i * 7 + i / 251);
+
+    char path[] = "/tmp/asyncreaderXXXXXX";
+    int  file   = mkstemp(path);
+    bool ok     = file >= 0 && write(file, random.data(), random.size()) == ssize_t(random.size());
+
+    const size_t sizes[] = { 0, 1, BufferSize - 1, BufferSize, BufferSize + 1, NumBuffers * BufferSize + 13, random.size() };
+    for (int useIoUring = 1; useIoUring >= 0 && ok; useIoUring--)
+    {
+      // the last bytes of a file: reading starts at the current file position
+      for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+      {
+        size_t start = random.size() - sizes[i];
+        lseek(file, off_t(start), SEEK_SET);
+        AsyncReader reader(file, BufferSize, NumBuffers, useIoUring != 0);
+        if (i == 0)
+          std::cout << "test AsyncReader (" << reader.getImplementation() << ") ...\n";
+
+        SHA256 sha256;
+        const void* data;
+        ptrdiff_t   numBytes;
+        while ((numBytes = reader.next(data)) > 0)
+          sha256.add(data, size_t(numBytes));
+        if (numBytes != 0 || sha256.getHash() != SHA256()(random.data() + start, sizes[i]))
+        {
+          std::cerr << "AsyncReader failed to read " << sizes[i] << " bytes of a file" << std::endl;
+          errors++;
+        }
+      }
+
+      // pipes return short reads, writer produces odd-sized pieces
+      int handles[2];
+      if (pipe(handles) != 0)
+        break;
+      std::thread writer([&]
+      {
+        for (size_t pos = 0; pos < random.size(); pos += 997)
+          if (write(handles[1], random.data() + pos, std::min(size_t(997), random.size() - pos)) < 0)
+            break;
+        close(handles[1]);
+      });
+      {
+        AsyncReader reader(handles[0], BufferSize, NumBuffers, useIoUring != 0);
+        SHA256 sha256;
+        const void* data;
+        ptrdiff_t   numBytes;
+        while ((numBytes = reader.next(data)) > 0)
+          sha256.add(data, size_t(numBytes));
+        if (numBytes != 0 || sha256.getHash() != SHA256()(random))
+        {
+          std::cerr << "AsyncReader failed to read a pipe" << std::endl;
+          errors++;
+        }
+      }
+      writer.join();
+      close(handles[0]);
+
+      // directories can't be read
+      int directory = open("/tmp", O_RDONLY);
+      {
+        AsyncReader reader(directory, BufferSize, NumBuffers, useIoUring != 0);
+        const void* data;
+        if (reader.next(data) != -1)
+        {
+          std::cerr << "AsyncReader didn't report an error" << std::endl;
+          errors++;
+        }
+      }
+      close(directory);
+    }
+
+    if (!ok)
+    {
+      std::cerr << "can't create temporary file for AsyncReader" << std::endl;
+      errors++;
+    }
+    if (file >= 0)
+    {
+      close(file);
+      unlink(path);
+    }
+  }
+
+#endif
   // next test case produced an error until February 2015, reported by Gary Singer
   // note: automatic test case 71 failed, too, same bug
   std::cout << "test SHA3/512 ...\n";
@@ -351,6 +959,21 @@ int main()
                               hex2bin("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
                               "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2");
 
+  // HMAC SHA384 and SHA512 test vectors from RFC4231
+  std::cout << "test HMAC(SHA384) and HMAC(SHA512) ...\n";
+  errors += checkHmac<SHA512>(std::string("Hi There"),
+                              hex2bin("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b"),
+                              "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cdedaa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854");
+  errors += checkHmac<SHA384>(std::string("what do ya want for nothing?"),
+                              std::string("Jefe"),
+                              "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e8e2240ca5e69e2c78b3239ecfab21649");
+  errors += checkHmac<SHA512>(std::string("what do ya want for nothing?"),
+                              std::string("Jefe"),
+                              "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+  errors += checkHmac<SHA512>(std::string("Test Using Larger Than Block-Size Key - Hash Key First"),
+                              hex2bin("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
+                              "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598");
+
   // summary
   if (errors == 0)
     std::cout << "all tests ok" << std::endl;
@@ -0,0 +1,215 @@
+// //////////////////////////////////////////////////////////
+// threadpool.cpp
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#include "threadpool.h"
+
+
+namespace
+{
+  /// pool of the current thread (NULL if not a worker thread)
+  thread_local ThreadPool* currentPool   = NULL;
+  /// index of the current worker thread
+  thread_local size_t      currentWorker = 0;
+}
+
+
+/// start threads, numThreads = 0 means "one per CPU core"
+ThreadPool::ThreadPool(unsigned int numThreads)
+: m_queued(0),
+  m_pending(0),
+  m_stop(false),
+  m_nextQueue(0)
+{
+  if (numThreads == 0)
+    numThreads = std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 1;
+
+  for (unsigned int i = 0; i < numThreads; i++)
+    m_queues.push_back(new Queue);
+  for (unsigned int i = 0; i < numThreads; i++)
+    m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, size_t(i)));
+}
+
+
+/// finish all tasks and terminate threads
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_signal.notify_all();
+
+  for (size_t i = 0; i < m_threads.size(); i++)
+    m_threads[i].join();
+  for (size_t i = 0; i < m_queues.size(); i++)
+    delete m_queues[i];
+}
+
+
+/// process-wide pool with one thread per CPU core, created on first use
+ThreadPool& ThreadPool::shared()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+
+/// number of worker threads
+unsigned int ThreadPool::getNumThreads() const
+{
+  return (unsigned int) m_threads.size();
+}
+
+
+/// add a task to a queue, preferably the current worker's queue
+void ThreadPool::push(const Task& task, size_t queue)
+{
+  // announce task before it becomes visible, so m_queued never underflows in pop()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued++;
+  }
+
+  {
+    Queue& target = *m_queues[queue % m_queues.size()];
+    std::lock_guard<std::mutex> lock(target.lock);
+    target.tasks.push_back(task);
+  }
+
+  m_signal.notify_one();
+}
+
+
+/// take a task from own queue or steal one from other workers, return false if all queues are empty
+bool ThreadPool::pop(Task& task)
+{
+  size_t numQueues = m_queues.size();
+  size_t own       = currentPool == this ? currentWorker : 0;
+
+  for (size_t i = 0; i < numQueues; i++)
+  {
+    Queue& queue = *m_queues[(own + i) % numQueues];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (queue.tasks.empty())
+      continue;
+
+    if (i == 0 && currentPool == this)
+    {
+      // own queue: newest task first (its data is most likely still in the cache)
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+    }
+    else
+    {
+      // steal oldest task
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+    }
+
+    std::lock_guard<std::mutex> counter(m_mutex);
+    m_queued--;
+    return true;
+  }
+
+  return false;
+}
+
+
+/// main loop of each worker thread
+void ThreadPool::workerLoop(size_t id)
+{
+  currentPool   = this;
+  currentWorker = id;
+
+  for (;;)
+  {
+    Task task;
+    if (pop(task))
+    {
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop && m_queued == 0)
+      m_signal.wait(lock);
+    if (m_stop && m_queued == 0)
+      return;
+  }
+}
+
+
+/// run task(0), task(1), ..., task(numTasks - 1) and return when all are finished
+void ThreadPool::run(size_t numTasks, const IndexedTask& task)
+{
+  // nothing to distribute
+  if (numTasks <= 1)
+  {
+    if (numTasks == 1)
+      task(0);
+    return;
+  }
+
+  std::atomic<size_t> remaining(numTasks);
+
+  // contiguous ranges of tasks per queue, idle workers will steal if the load is unbalanced
+  size_t numQueues = m_queues.size();
+  for (size_t i = 0; i < numTasks; i++)
+    push([this, &task, &remaining, i]()
+         {
+           task(i);
+           if (--remaining == 0)
+           {
+             std::lock_guard<std::mutex> lock(m_mutex);
+             m_signal.notify_all();
+           }
+         }, i * numQueues / numTasks);
+
+  // help until all my tasks are done
+  while (remaining > 0)
+  {
+    Task next;
+    if (pop(next))
+    {
+      next();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (remaining > 0 && m_queued == 0)
+      m_signal.wait(lock);
+  }
+}
+
+
+/// enqueue a task, returns immediately
+void ThreadPool::submit(const Task& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending++;
+  }
+
+  size_t queue = currentPool == this ? currentWorker : m_nextQueue++;
+  push([this, task]()
+       {
+         task();
+         std::lock_guard<std::mutex> lock(m_mutex);
+         if (--m_pending == 0)
+           m_signal.notify_all();
+       }, queue);
+}
+
+
+/// wait until all tasks enqueued by submit() are finished (don't call from inside a task)
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_pending > 0)
+    m_signal.wait(lock);
+}
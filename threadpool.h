@@ -0,0 +1,96 @@
+// //////////////////////////////////////////////////////////
+// threadpool.h
+// Copyright (c) 2026 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+
+/// work-stealing thread pool, used by all parallel hashing modes
+/** Usage:
+    ThreadPool pool;      // one worker per CPU core
+    pool.run(numTasks, [&](size_t task) { ... }); // returns when all tasks are finished
+
+    // or without a dedicated pool:
+    ThreadPool::shared().run(numTasks, ...);
+
+    Each worker owns a task queue: it takes tasks from the back of its own queue and
+    steals from the front of other workers' queues when it runs out of work.
+    run() can be called from inside a task, the calling thread helps processing tasks
+    while it waits for its own tasks.
+  */
+class ThreadPool
+{
+public:
+  /// a single task
+  typedef std::function<void()>       Task;
+  /// a task which is called with its index
+  typedef std::function<void(size_t)> IndexedTask;
+
+  /// start threads, numThreads = 0 means "one per CPU core"
+  explicit ThreadPool(unsigned int numThreads = 0);
+  /// finish all tasks and terminate threads
+  ~ThreadPool();
+
+  /// process-wide pool with one thread per CPU core, created on first use
+  static ThreadPool& shared();
+
+  /// number of worker threads
+  unsigned int getNumThreads() const;
+
+  /// run task(0), task(1), ..., task(numTasks - 1) and return when all are finished
+  void run(size_t numTasks, const IndexedTask& task);
+
+  /// enqueue a task, returns immediately
+  void submit(const Task& task);
+  /// wait until all tasks enqueued by submit() are finished (don't call from inside a task)
+  void wait();
+
+private:
+  /// no copies
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+  /// a worker's queue
+  struct Queue
+  {
+    std::mutex       lock;
+    std::deque<Task> tasks;
+  };
+
+  /// add a task to a queue, preferably the current worker's queue
+  void push(const Task& task, size_t queue);
+  /// take a task from own queue or steal one from other workers, return false if all queues are empty
+  bool pop(Task& task);
+  /// main loop of each worker thread
+  void workerLoop(size_t id);
+
+  /// one queue per worker
+  std::vector<Queue*>      m_queues;
+  /// worker threads
+  std::vector<std::thread> m_threads;
+
+  /// protects the following members and is used by m_signal
+  std::mutex               m_mutex;
+  /// wakes up idle workers and threads waiting in run() / wait()
+  std::condition_variable  m_signal;
+  /// number of queued tasks (not yet started)
+  size_t                   m_queued;
+  /// number of submit()ed tasks not finished yet
+  size_t                   m_pending;
+  /// true if destructor was called
+  bool                     m_stop;
+
+  /// round-robin position for tasks enqueued by non-worker threads
+  std::atomic<size_t>      m_nextQueue;
+};